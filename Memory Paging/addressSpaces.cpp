@@ -0,0 +1,160 @@
+//This is the work of Teddy Barker
+
+#include "addressSpaces.h"
+
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+AddressSpaces::AddressSpaces(unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config)
+    : tlbs(config) {
+    pageTableBackend = config.pageTableBackend;
+    this->levelCount = levelCount;
+    this->entryCount = new unsigned int[levelCount];
+    for (unsigned int i = 0; i < levelCount; i++)
+        this->entryCount[i] = entryCount[i];
+
+    //The VPN is every bit above the offset, the level sizes are powers of 2
+    offsetShift = BIT_SIZE;
+    for (unsigned int i = 0; i < levelCount; i++)
+        offsetShift -= __builtin_ctz(entryCount[i]);
+
+    //Address spaces are only created once their proc shows up in the trace
+    for (int proc = 0; proc < MAX_ADDRESS_SPACES; proc++) {
+        spaces[proc] = nullptr;
+        tlbHits[proc] = 0;
+    }
+}
+
+AddressSpaces::~AddressSpaces() {
+    for (int proc = 0; proc < MAX_ADDRESS_SPACES; proc++)
+        delete spaces[proc];
+    delete[] entryCount;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Simulates the first recordCount records of the trace, the shared TLBs on
+ * the calling thread and the page tables on up to threads worker threads
+ */
+void AddressSpaces::run(TraceMap* traceMap, size_t recordCount, unsigned int threads) {
+    const p2AddrTr* records = traceMap->getRecords();
+
+    if (threads > MAX_ADDRESS_SPACES)
+        threads = MAX_ADDRESS_SPACES;
+    if (threads < 1)
+        threads = 1;
+
+    //Each worker owns the procs that are equal to its shard modulo the number of workers
+    vector<vector<size_t> > shardRecords(threads);
+    for (size_t record = 0; record < recordCount; record++)
+        shardRecords[records[record].proc % threads].push_back(record);
+
+    vector<thread> workers;
+    for (unsigned int shard = 0; shard < threads; shard++) {
+        workers.push_back(thread([this, records, &shardRecords, shard]() {
+            simulateShard(records, shardRecords[shard]);
+        }));
+    }
+
+    simulateTlbs(records, recordCount);
+
+    for (thread& worker : workers)
+        worker.join();
+}
+
+/**
+ * Runs every record through the shared TLB hierarchy, tagged with its proc,
+ * and counts the TLB hits of each process. No page table is walked here, a
+ * miss inserts PFN 0 since only whether the VPN is cached matters
+ */
+void AddressSpaces::simulateTlbs(const p2AddrTr* records, size_t recordCount) {
+    unsigned char level;
+    bool hugePage;
+    for (size_t record = 0; record < recordCount; record++) {
+        unsigned int vpn = records[record].addr >> offsetShift;
+        unsigned char proc = records[record].proc;
+        if (tlbs.lookup(vpn, records[record].reqtype, proc, level, hugePage) != -1)
+            tlbHits[proc]++;
+        else
+            tlbs.insert(vpn, 0, records[record].reqtype, proc, false);
+    }
+}
+
+/**
+ * Walks the page tables of the procs in one shard over the records of those procs, in
+ * trace order. The simulators have no TLBs, their TLB hits come from the shared hierarchy
+ */
+void AddressSpaces::simulateShard(const p2AddrTr* records, const vector<size_t>& shardRecords) {
+    SimulatorConfig pageTableOnly = SimulatorConfig();
+    pageTableOnly.pageTableBackend = pageTableBackend;
+    pageTableOnly.addressBits = BIT_SIZE;
+    Translation translation;
+    for (size_t record : shardRecords) {
+        unsigned char proc = records[record].proc;
+        if (spaces[proc] == nullptr)
+            spaces[proc] = new Simulator(levelCount, entryCount, pageTableOnly);
+        spaces[proc]->translate(records[record].addr, records[record].reqtype, records[record].time, translation);
+    }
+}
+
+/**
+ * Returns true if the proc made at least one access
+ */
+bool AddressSpaces::isUsed(unsigned int proc) {
+    return spaces[proc] != nullptr;
+}
+
+/**
+ * Merges the page table and TLB counts of one address space
+ */
+AddressSpaceResult AddressSpaces::getResult(unsigned int proc) {
+    AddressSpaceResult result = AddressSpaceResult();
+    if (spaces[proc] == nullptr)
+        return result;
+
+    //Every TLB hit would have been a page table hit without the TLB
+    PageTable* pageTable = spaces[proc]->getPageTable();
+    result.accesses = spaces[proc]->getAccessCount();
+    result.tlbHits = tlbHits[proc];
+    result.pageTableHits = spaces[proc]->getPageTableHits() - tlbHits[proc];
+    result.framesAllocated = pageTable->getFramesAllocated();
+    result.pageTableEntries = pageTable->getTotalPageTableEntries();
+    return result;
+}
+
+/**
+ * Sums the results of every address space, each numbers its own frames from 0
+ */
+AddressSpaceResult AddressSpaces::getTotal() {
+    AddressSpaceResult total = AddressSpaceResult();
+    for (int proc = 0; proc < MAX_ADDRESS_SPACES; proc++) {
+        AddressSpaceResult result = getResult(proc);
+        total.accesses += result.accesses;
+        total.tlbHits += result.tlbHits;
+        total.pageTableHits += result.pageTableHits;
+        total.framesAllocated += result.framesAllocated;
+        total.pageTableEntries += result.pageTableEntries;
+    }
+    return total;
+}
+
+/**
+ * Getter for the page size, the same in every address space
+ */
+unsigned int AddressSpaces::getPageSize() {
+    return 1 << offsetShift;
+}
+
+/**
+ * Getter for the shared TLB hierarchy, for its per level counts
+ */
+TLBHierarchy* AddressSpaces::getTlbs() {
+    return &tlbs;
+}
@@ -0,0 +1,66 @@
+//This is the work of Teddy Barker
+
+#ifndef ADDRESSSPACES_H
+#define ADDRESSSPACES_H
+
+#include <stddef.h>
+#include <vector>
+#include "simulator.h"
+#include "traceMap.h"
+
+//One address space per value of p2AddrTr.proc
+#define MAX_ADDRESS_SPACES 256
+
+/**
+ * This Struct holds the summary of one address space once the trace has run
+ */
+struct AddressSpaceResult {
+    unsigned long accesses;
+    unsigned long tlbHits;
+    unsigned long pageTableHits;
+    unsigned int framesAllocated;
+    unsigned long pageTableEntries;
+};
+
+/*
+ * Address Spaces class
+ *   Simulates every process of a trace in its own address space, one
+ *   page table per p2AddrTr.proc. The processes share one TLB hierarchy
+ *   whose entries are tagged with the proc as ASID, so switching between
+ *   processes needs no flush.
+ *
+ *   The shared TLBs are run over the whole trace on the calling thread,
+ *   while the page tables are sharded across worker threads by proc. The
+ *   records of each shard are listed in one pass first, so every worker
+ *   only reads its own records.
+ *   A TLB hit or miss does not depend on the PFN, and a page walk after a
+ *   TLB miss only misses on the first touch of a page, so the page table
+ *   hits of a process are its page table only hits less its TLB hits.
+*/
+class AddressSpaces {
+    public:
+        AddressSpaces(unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config);
+        ~AddressSpaces();
+
+        void run(TraceMap* traceMap, size_t recordCount, unsigned int threads);
+
+        bool isUsed(unsigned int proc);
+        AddressSpaceResult getResult(unsigned int proc);
+        AddressSpaceResult getTotal();
+        unsigned int getPageSize();
+        TLBHierarchy* getTlbs();
+
+    private:
+        unsigned int levelCount;
+        unsigned int* entryCount;
+        unsigned int offsetShift;
+        PageTableBackend pageTableBackend;
+        TLBHierarchy tlbs;
+        Simulator* spaces[MAX_ADDRESS_SPACES];
+        unsigned long tlbHits[MAX_ADDRESS_SPACES];
+
+        void simulateTlbs(const p2AddrTr* records, size_t recordCount);
+        void simulateShard(const p2AddrTr* records, const std::vector<size_t>& shardRecords);
+};
+
+#endif
@@ -0,0 +1,34 @@
+#!/bin/sh
+#This is the work of Teddy Barker
+
+#Checks the -m curve against a -c run at every capacity, over a byu64 trace whose
+#pages sit above 2^32 next to pages with the same low 32 bits, and long enough that
+#the stack distance renumbers its times several times
+
+PROGRAM=./pagingwithatc
+CAPACITY=12
+TRACE=$(mktemp)
+trap 'rm -f "$TRACE" "$TRACE.curve"' EXIT
+
+python3 - "$TRACE" <<'GENERATE' || exit 1
+import random, struct, sys
+random.seed(825169794)
+with open(sys.argv[1], 'wb') as trace:
+    for time in range(200000):
+        vpn = random.randrange(16) + (random.randrange(2) << 32)
+        trace.write(struct.pack('<QBBBBI', (vpn << 12) | 0x10, 2, 4, 0, 0, time))
+GENERATE
+
+$PROGRAM -f byu64 -v 64 -m $CAPACITY "$TRACE" 13 13 13 13 > "$TRACE.curve" || exit 1
+failed=0
+for capacity in $(seq 1 $CAPACITY); do
+    expected=$($PROGRAM -f byu64 -v 64 -c $capacity "$TRACE" 13 13 13 13 | sed -n 's/^Cache hits: \([0-9]*\),.*/\1/p')
+    curve=$(sed -n "s/^Capacity $capacity: hits \([0-9]*\),.*/\1/p" "$TRACE.curve")
+    if [ "$expected" != "$curve" ]; then
+        echo "Capacity $capacity: -m gives $curve hits, -c gives $expected"
+        failed=1
+    fi
+done
+
+[ $failed = 0 ] && echo "Curve matches -c at every capacity up to $CAPACITY"
+exit $failed
@@ -0,0 +1,201 @@
+//This is the work of Teddy Barker
+
+#include "frameTable.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+FrameTable::FrameTable(unsigned int frames, EvictionPolicyType policy, uint64_t window) {
+    this->frames = frames;
+    this->policy = policy;
+    this->window = window;
+    now = 0;
+    used = 0;
+
+    owners = new FrameOwner[frames];
+    referenced = new unsigned char[frames]();
+    lastUse = new uint64_t[frames]();
+    hand = 0;
+    windowCovers = 0;
+
+    evictions = 0;
+    evictionPending = false;
+    evictedVpn = 0;
+}
+
+FrameTable::~FrameTable() {
+    delete[] owners;
+    delete[] referenced;
+    delete[] lastUse;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Returns true once every frame has been handed out, so a new page needs an eviction
+ */
+bool FrameTable::isFull() {
+    return used == frames;
+}
+
+/**
+ * Hands out the next frame that has never been used, memory must not be full
+ */
+unsigned int FrameTable::claim() {
+    return used++;
+}
+
+/**
+ * Picks a frame to take back with the eviction policy and remembers the VPN
+ * that was mapped to it. The caller unmaps it from the page table
+ */
+unsigned int FrameTable::evict() {
+    unsigned int frame;
+    switch (policy) {
+        case EVICT_CLOCK:
+            frame = sweepClock();
+            break;
+        case EVICT_WSCLOCK:
+            frame = sweepWorkingSet();
+            break;
+        default:
+            //Frames are refilled in place, so the one after the last replaced is the oldest
+            frame = hand;
+            advanceHand();
+            break;
+    }
+
+    evictions++;
+    evictionPending = true;
+    evictedVpn = owners[frame].vpn;
+    return frame;
+}
+
+/**
+ * Records the page table entry that now maps this frame
+ */
+void FrameTable::setOwner(unsigned int pfn, uint64_t vpn, Level* level, unsigned int index) {
+    owners[pfn].vpn = vpn;
+    owners[pfn].level = level;
+    owners[pfn].index = index;
+}
+
+/**
+ * Getter for the page table entry that maps this frame
+ */
+const FrameOwner& FrameTable::getOwner(unsigned int pfn) {
+    return owners[pfn];
+}
+
+/**
+ * Returns true with the VPN of the page evicted since the last call, if there was one
+ */
+bool FrameTable::takeEviction(uint64_t& vpn) {
+    if (!evictionPending)
+        return false;
+
+    evictionPending = false;
+    vpn = evictedVpn;
+    return true;
+}
+
+/**
+ * Getter for the number of frames of physical memory
+ */
+unsigned int FrameTable::getFrameCount() {
+    return frames;
+}
+
+/**
+ * Getter for the number of pages evicted
+ */
+unsigned long FrameTable::getEvictions() {
+    return evictions;
+}
+
+/**
+ * Sweeps the hand to the first frame not referenced since the last sweep
+ */
+unsigned int FrameTable::sweepClock() {
+    while (referenced[hand]) {
+        referenced[hand] = 0;
+        advanceHand();
+    }
+
+    unsigned int frame = hand;
+    advanceHand();
+    return frame;
+}
+
+/**
+ * Sweeps the hand to the first frame that is neither referenced nor used within
+ * the working set window. Goes around at most once, then falls back to CLOCK
+ */
+unsigned int FrameTable::sweepWorkingSet() {
+    //The last sweep showed that every frame is still inside the window
+    if (now <= windowCovers)
+        return sweepClock();
+
+    uint64_t oldest = lastUse[hand];
+    for (unsigned int passed = 0; passed < frames; passed++) {
+        unsigned int frame = hand;
+        advanceHand();
+
+        if (referenced[frame])
+            referenced[frame] = 0;
+        else if (now - lastUse[frame] > window)
+            return frame;
+
+        if (lastUse[frame] < oldest)
+            oldest = lastUse[frame];
+    }
+
+    //Every frame was used within the window, and none can leave it before the oldest does
+    windowCovers = oldest + window;
+    return sweepClock();
+}
+
+/**
+ * Moves the hand to the next frame, wrapping around at the end
+ */
+void FrameTable::advanceHand() {
+    hand = (hand + 1 == frames) ? 0 : hand + 1;
+}
+
+/**
+ * Looks up an eviction policy by its command line name, fifo, clock or wsclock.
+ * wsclock may be followed by :<window> to set its working set window. Returns
+ * false if there is no policy by that name
+ */
+bool FrameTable::parse(const char* name, EvictionPolicyType& policy, uint64_t& window) {
+    window = DEFAULT_WORKING_SET_WINDOW;
+    if (strcmp(name, "fifo") == 0) {
+        policy = EVICT_FIFO;
+        return true;
+    }
+    if (strcmp(name, "clock") == 0) {
+        policy = EVICT_CLOCK;
+        return true;
+    }
+    if (strncmp(name, "wsclock", 7) == 0) {
+        policy = EVICT_WSCLOCK;
+        if (name[7] == '\0')
+            return true;
+        if (name[7] != ':')
+            return false;
+
+        char* end;
+        long long value = strtoll(name + 8, &end, 10);
+        if (end == name + 8 || *end != '\0' || value <= 0)
+            return false;
+        window = value;
+        return true;
+    }
+    return false;
+}
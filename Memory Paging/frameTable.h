@@ -0,0 +1,113 @@
+//This is the work of Teddy Barker
+
+#ifndef FRAMETABLE_H
+#define FRAMETABLE_H
+
+#include <stdint.h>
+
+class Level;
+
+//Working set window of WSClock when none is given, in p2AddrTr.time units
+#define DEFAULT_WORKING_SET_WINDOW 50000
+
+/**
+ * The policies that pick which frame to take when physical memory is full
+ */
+enum EvictionPolicyType {
+    EVICT_FIFO,
+    EVICT_CLOCK,
+    EVICT_WSCLOCK
+};
+
+/**
+ * This Struct holds the reverse mapping of one frame:
+ *  - the VPN mapped to it, for shooting down its TLB entries
+ *  - the leaf level and index of the entry that maps it, nullptr for a hashed page table
+ */
+struct FrameOwner {
+    uint64_t vpn;
+    Level* level;
+    unsigned int index;
+};
+
+/*
+ * Frame Table class
+ *   Bounded physical memory, a fixed number of frames with the page
+ *   mapped to each. Frames are handed out in order until memory is
+ *   full, then an eviction policy picks the frame to take back:
+ *    - FIFO replaces frames in the order they were filled, which for a
+ *      fixed set of frames is a hand stepping through them
+ *    - CLOCK sweeps the hand past frames referenced since the last
+ *      sweep, clearing their bits, to the first one that was not
+ *    - WSClock sweeps the same way but also skips unreferenced frames
+ *      used within the working set window. Each p2AddrTr.time is the
+ *      time since the record before it, and the table keeps their sum
+ *   The hand clears a bit for every frame it passes, and a bit is only
+ *   set by an access, so each eviction is O(1) amortized. A WSClock
+ *   sweep that goes all the way around without finding a frame outside
+ *   the window falls back to CLOCK until the oldest frame it saw could
+ *   have left the window, so it does not go around again meanwhile.
+*/
+class FrameTable {
+    public:
+        FrameTable(unsigned int frames, EvictionPolicyType policy, uint64_t window);
+        ~FrameTable();
+
+        //The table owns its frames, so it can not be copied
+        FrameTable(const FrameTable&) = delete;
+        FrameTable& operator=(const FrameTable&) = delete;
+
+        bool isFull();
+        unsigned int claim();
+        unsigned int evict();
+
+        void setOwner(unsigned int pfn, uint64_t vpn, Level* level, unsigned int index);
+        const FrameOwner& getOwner(unsigned int pfn);
+        void advance(uint64_t elapsed);
+        void touch(unsigned int pfn);
+        bool takeEviction(uint64_t& vpn);
+
+        unsigned int getFrameCount();
+        unsigned long getEvictions();
+
+        static bool parse(const char* name, EvictionPolicyType& policy, uint64_t& window);
+
+    private:
+        unsigned int frames;
+        unsigned int used; //Frames handed out so far, every one once memory is full
+        EvictionPolicyType policy;
+        uint64_t window;
+        uint64_t now; //Sum of the times of every record so far
+
+        FrameOwner* owners;
+        unsigned char* referenced;
+        uint64_t* lastUse;
+        unsigned int hand;
+        uint64_t windowCovers; //No frame can be outside the window before this time
+
+        unsigned long evictions;
+        bool evictionPending;
+        uint64_t evictedVpn;
+
+        unsigned int sweepClock();
+        unsigned int sweepWorkingSet();
+        void advanceHand();
+};
+
+/**
+ * Moves the clock forward by the time of the next record.
+ * Defined here, like touch, so that the simulator can inline it
+ */
+inline void FrameTable::advance(uint64_t elapsed) {
+    now += elapsed;
+}
+
+/**
+ * Marks a frame as referenced now, called for every access to it
+ */
+inline void FrameTable::touch(unsigned int pfn) {
+    referenced[pfn] = 1;
+    lastUse[pfn] = now;
+}
+
+#endif
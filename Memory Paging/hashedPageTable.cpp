@@ -0,0 +1,107 @@
+//This is the work of Teddy Barker
+
+#include "hashedPageTable.h"
+#include <cstring>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+HashedPageTable::HashedPageTable(unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits)
+    : PageTable(levelCount, entryCount, addressBits) {
+    slots = new HashedEntry[HASHED_INITIAL_SLOTS];
+    memset(slots, 0xFF, HASHED_INITIAL_SLOTS * sizeof(HashedEntry)); //Every byte of HASHED_EMPTY_VPN is 0xFF
+    slotMask = HASHED_INITIAL_SLOTS - 1;
+    slotShift = MAX_BIT_SIZE - bitwiseLog2(HASHED_INITIAL_SLOTS);
+}
+
+HashedPageTable::~HashedPageTable() {
+    delete[] slots;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Returns the integer for the physical frame number for this address,
+ * it also tracks pagetable hit or miss using the flag
+ */
+unsigned int HashedPageTable::recordPageAccess(uint64_t address, bool &flag) {
+    //Bits above the address width, such as the sign extension of a canonical address, are not part of the VPN
+    return mapPage((address & getAddressMask()) >> shiftAry[levelCount - 1], flag);
+}
+
+/**
+ * Doubles the number of slots and rehashes every mapping into them
+ */
+void HashedPageTable::grow() {
+    HashedEntry* oldSlots = slots;
+    unsigned int oldCount = slotMask + 1;
+
+    slots = new HashedEntry[oldCount * 2];
+    memset(slots, 0xFF, oldCount * 2 * sizeof(HashedEntry));
+    slotMask = oldCount * 2 - 1;
+    slotShift--;
+
+    for (unsigned int i = 0; i < oldCount; i++) {
+        if (oldSlots[i].vpn == HASHED_EMPTY_VPN)
+            continue;
+
+        unsigned int slot = slotOf(oldSlots[i].vpn);
+        while (slots[slot].vpn != HASHED_EMPTY_VPN)
+            slot = (slot + 1) & slotMask;
+        slots[slot] = oldSlots[i];
+    }
+
+    delete[] oldSlots;
+}
+
+/**
+ * Removes the mapping of an evicted page, moving later entries of its probe run
+ * back into the gap when the empty slot would cut them off from their home slot
+ */
+void HashedPageTable::unmapPage(const FrameOwner& owner) {
+    unsigned int slot = slotOf(owner.vpn);
+    while (slots[slot].vpn != owner.vpn)
+        slot = (slot + 1) & slotMask;
+
+    unsigned int gap = slot;
+    for (slot = (slot + 1) & slotMask; slots[slot].vpn != HASHED_EMPTY_VPN; slot = (slot + 1) & slotMask) {
+        //An entry can fill the gap if its home slot is not after the gap on the way to it
+        unsigned int home = slotOf(slots[slot].vpn);
+        if (((slot - home) & slotMask) >= ((slot - gap) & slotMask)) {
+            slots[gap] = slots[slot];
+            gap = slot;
+        }
+    }
+    slots[gap].vpn = HASHED_EMPTY_VPN;
+}
+
+/**
+ * Getter for the total page table entries, every slot whether it is mapped or not
+ */
+unsigned long HashedPageTable::getTotalPageTableEntries() {
+    return slotMask + 1;
+}
+
+/**
+ * Getter for the number of levels allocated, the table is a single level
+ */
+unsigned long HashedPageTable::getLevelsAllocated() {
+    return 1;
+}
+
+/**
+ * Getter for the bytes the slots of this page table take
+ */
+size_t HashedPageTable::getBytesUsed() {
+    return (size_t) (slotMask + 1) * sizeof(HashedEntry);
+}
+
+/**
+ * Getter for the backend, the hashed table
+ */
+PageTableBackend HashedPageTable::getBackend() {
+    return BACKEND_HASHED;
+}
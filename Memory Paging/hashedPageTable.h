@@ -0,0 +1,94 @@
+//This is the work of Teddy Barker
+
+#ifndef HASHEDPAGETABLE_H
+#define HASHEDPAGETABLE_H
+
+#include "pageTable.h"
+
+//VPN of a slot that holds no mapping, VPNs never use all 64 bits
+#define HASHED_EMPTY_VPN 0xFFFFFFFFFFFFFFFFull
+
+//Slots in a new hashed page table, it doubles whenever it is half full
+#define HASHED_INITIAL_SLOTS 1024
+
+/**
+ * This Struct is one slot of the hashed page table, the VPN and its PFN
+ * side by side so that a probe reads both from the same cache line
+ */
+struct HashedEntry {
+    uint64_t vpn;
+    unsigned int pfn;
+};
+
+/*
+ * Hashed Page Table class
+ *   The hashed backend, a single open addressing table from VPN to PFN
+ *   in place of the tree of levels. Its size follows the pages that are
+ *   mapped rather than the shape of the address space, and a walk is one
+ *   hash and a short linear probe instead of a pointer per level.
+ *   Evicted pages are deleted by shifting the rest of their probe run
+ *   back, so no tombstones build up as frames are replaced.
+*/
+class HashedPageTable : public PageTable {
+    public:
+        HashedPageTable(unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits);
+        ~HashedPageTable();
+
+        unsigned int recordPageAccess(uint64_t address, bool &flag);
+        unsigned int mapPage(uint64_t vpn, bool &flag);
+
+        PageTableBackend getBackend();
+        unsigned long getTotalPageTableEntries();
+        unsigned long getLevelsAllocated();
+        size_t getBytesUsed();
+        void unmapPage(const FrameOwner& owner);
+
+    private:
+        HashedEntry* slots;
+        unsigned int slotMask;
+        unsigned int slotShift;
+
+        unsigned int slotOf(uint64_t vpn);
+        void grow();
+};
+
+/**
+ * Returns the home slot of a VPN, multiplying by 2^64 / golden ratio spreads nearby pages apart
+ */
+inline unsigned int HashedPageTable::slotOf(uint64_t vpn) {
+    return (vpn * 0x9E3779B97F4A7C15ull) >> slotShift;
+}
+
+/**
+ * Returns the PFN mapped to this VPN, mapping the next available frame if
+ * there is none yet. The flag is set on a pagetable hit. Defined here so
+ * that the page walker can inline it
+ */
+inline unsigned int HashedPageTable::mapPage(uint64_t vpn, bool &flag) {
+    unsigned int slot = slotOf(vpn);
+    while (slots[slot].vpn != vpn) {
+        if (slots[slot].vpn == HASHED_EMPTY_VPN) {
+            //Store the next available PFN in the empty slot that ended the probe
+            unsigned int pfn = allocateFrame(vpn, nullptr, 0);
+            if (frameTable != nullptr) {
+                //Unmapping the evicted page may have opened an earlier slot on the probe
+                for (slot = slotOf(vpn); slots[slot].vpn != HASHED_EMPTY_VPN; slot = (slot + 1) & slotMask);
+            }
+            slots[slot].vpn = vpn;
+            slots[slot].pfn = pfn;
+
+            //Keep the table at most half full so probes stay short
+            if (framesAllocated * 2 > slotMask + 1)
+                grow();
+
+            flag = false;
+            return pfn;
+        }
+        slot = (slot + 1) & slotMask;
+    }
+
+    flag = true;
+    return slots[slot].pfn;
+}
+
+#endif
@@ -9,22 +9,25 @@ using namespace std;
 /*****************
 ** CONSTRUCTORS **
 *****************/
-Level::Level(unsigned int depth, unsigned int size, PageTable* pageTablePtr) {
-    //Constructor for the Level that takes in the depth, size, and pointer to the page table object that manages the root level attribute
-    if(size == 0)
-        nextPtr = nullptr; //Do not allocate memory if the size should be 0
-    else
-        nextPtr = new Level* [size]; //Allocate memory for the sub levels, but the will start as nulltpr
-
-    //Initialize all entries of the level array as nullptr, until they are required
-    for(int i = 0; i < size; i++) {
-        nextPtr[i] = nullptr;
-    }
+Level::Level(unsigned int depth, unsigned int size, PageTable* pageTablePtr, Level** nextPtr, unsigned int* pfnAry) {
+    //Constructor for the Level that takes in the depth, size, pointer to the page table object that manages the root level attribute,
+    //and the array of size entries that the page table allocated for it. Interior levels get a zeroed child array
+    //and a nullptr pfnAry, levels on the last depth get a pfnAry filled with INVALID_PFN and a nullptr nextPtr
+    this->nextPtr = nextPtr;
+    this->pfnAry = pfnAry;
 
     //Update members
     this->depth = depth;
     this->pageTablePtr = pageTablePtr;
     this->size = size;
 
-    pfn = 0; //Begin with no accesses
+    //Levels are dense until the page table makes them compact
+    kind = LEVEL_DENSE;
+    count = 0;
+    keys = nullptr;
+    childIndex = nullptr;
+
+    //Levels start out as the parents of small pages
+    hugePfn = INVALID_PFN;
+    pagesMapped = 0;
 }
\ No newline at end of file
@@ -5,22 +5,60 @@
 
 class PageTable;
 
+//PFN stored in a leaf entry that has not been mapped yet
+#define INVALID_PFN 0xFFFFFFFF
+
+//Slot returned by a search of a compact level that does not hold the index
+#define LEVEL_NO_SLOT -1
+
+/**
+ * Kinds of level, each holding more entries than the one before it:
+ *  - up to 4 or 16 entries, their indices kept sorted in keys
+ *  - up to 48 entries, found through a byte per index in childIndex
+ *  - one entry per index, the only kind without adaptive levels
+ */
+enum LevelKind {
+    LEVEL_NODE4,
+    LEVEL_NODE16,
+    LEVEL_NODE48,
+    LEVEL_DENSE
+};
+
 /*
  * Level class
  *   An entry for an arbitrary level, this is the structure which 
  *   represents a node of one of the levels in the page tree/table.  
  *   It manages a pointer to another level as a double pointer.
+ *   Levels on the last depth map straight to frames instead, through
+ *   a flat array of PFNs where unmapped entries hold INVALID_PFN.
+ *   The arrays are handed in by the page table, which owns them.
+ *
+ *   A dense level has an entry for every index. Adaptive page tables
+ *   start levels compact, with nextPtr or pfnAry holding only the count
+ *   entries in use, and grow them to the next kind as they fill.
+ *
+ *   With huge pages, a level at the huge page depth counts the pages
+ *   mapped below it, and once it is promoted hugePfn holds the first
+ *   frame of the huge page that replaces everything below it.
 */
 class Level {
     public:
         unsigned int depth;
-        unsigned int pfn;
 
-        Level(unsigned depth, unsigned int size, PageTable* pageTablePtr);
+        Level(unsigned depth, unsigned int size, PageTable* pageTablePtr, Level** nextPtr, unsigned int* pfnAry);
 
         Level** nextPtr;
+        unsigned int* pfnAry;
         PageTable* pageTablePtr;
         unsigned int size;
+
+        LevelKind kind;
+        unsigned int count; //Entries in use by a compact level
+        unsigned int* keys; //Index of each entry in a 4 or 16 entry level
+        unsigned char* childIndex; //Entry of each index plus 1 in a 48 entry level, 0 if there is none
+
+        unsigned int hugePfn; //First frame of the huge page this level was promoted to, INVALID_PFN if it was not
+        unsigned int pagesMapped; //Pages mapped below a level at the huge page depth
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,132 @@
+//This is the work of Teddy Barker
+
+#include "levelArena.h"
+
+#include <new>
+#include <cstring>
+#include <sys/mman.h>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+LevelArena::LevelArena() {
+    //Nothing is reserved until the first allocation
+    slabs = nullptr;
+    cursor = nullptr;
+    limit = nullptr;
+    bytesReserved = 0;
+    bytesUsed = 0;
+    for (int i = 0; i < ARENA_FREE_LISTS; i++)
+        freeBlocks[i] = nullptr;
+}
+
+LevelArena::~LevelArena() {
+    release();
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Returns a zeroed, cache line aligned block of at least bytes bytes.
+ * The block lives until release is called
+ */
+void* LevelArena::allocate(size_t bytes) {
+    //Round the request up to a whole number of cache lines
+    bytes = (bytes + CACHE_LINE_SIZE - 1) & ~(size_t) (CACHE_LINE_SIZE - 1);
+    bytesUsed += bytes;
+
+    //Reuse a recycled block of the same size first
+    size_t lines = bytes / CACHE_LINE_SIZE;
+    if (lines <= ARENA_FREE_LISTS && freeBlocks[lines - 1] != nullptr) {
+        void* block = freeBlocks[lines - 1];
+        freeBlocks[lines - 1] = *(void**) block;
+        memset(block, 0, bytes);
+        return block;
+    }
+
+    if (bytes > SLAB_SIZE / 4) {
+        //Large child arrays get a slab of their own so they do not waste the current one
+        Slab* slab = reserveSlab(CACHE_LINE_SIZE + bytes);
+        return (char*) slab + CACHE_LINE_SIZE;
+    }
+
+    if (cursor == nullptr || (size_t) (limit - cursor) < bytes) {
+        //Start a new slab, the header takes the first cache line
+        Slab* slab = reserveSlab(SLAB_SIZE);
+        cursor = (char*) slab + CACHE_LINE_SIZE;
+        limit = (char*) slab + SLAB_SIZE;
+    }
+
+    void* block = cursor;
+    cursor += bytes;
+    return block;
+}
+
+/**
+ * Takes back a block of bytes bytes that will not be used again. Small
+ * blocks are kept for the next allocation of the same size, larger ones
+ * stay reserved until release
+ */
+void LevelArena::recycle(void* block, size_t bytes) {
+    bytes = (bytes + CACHE_LINE_SIZE - 1) & ~(size_t) (CACHE_LINE_SIZE - 1);
+    bytesUsed -= bytes;
+
+    size_t lines = bytes / CACHE_LINE_SIZE;
+    if (lines <= ARENA_FREE_LISTS) {
+        *(void**) block = freeBlocks[lines - 1];
+        freeBlocks[lines - 1] = block;
+    }
+}
+
+/**
+ * Returns every slab to the system, invalidating all blocks handed out
+ */
+void LevelArena::release() {
+    while (slabs != nullptr) {
+        Slab* next = slabs->next;
+        munmap(slabs, slabs->size);
+        slabs = next;
+    }
+
+    cursor = nullptr;
+    limit = nullptr;
+    bytesReserved = 0;
+    bytesUsed = 0;
+    for (int i = 0; i < ARENA_FREE_LISTS; i++)
+        freeBlocks[i] = nullptr;
+}
+
+/**
+ * Getter for the bytes currently reserved from the system
+ */
+size_t LevelArena::getBytesReserved() {
+    return bytesReserved;
+}
+
+/**
+ * Getter for the bytes in blocks that are handed out and not recycled
+ */
+size_t LevelArena::getBytesUsed() {
+    return bytesUsed;
+}
+
+/**
+ * Reserves a new slab of size bytes and links it in.
+ * Anonymous mappings are page aligned and already zero filled
+ */
+LevelArena::Slab* LevelArena::reserveSlab(size_t size) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        throw bad_alloc();
+
+    Slab* slab = (Slab*) memory;
+    slab->next = slabs;
+    slab->size = size;
+    slabs = slab;
+
+    bytesReserved += size;
+    return slab;
+}
@@ -0,0 +1,58 @@
+//This is the work of Teddy Barker
+
+#ifndef LEVELARENA_H
+#define LEVELARENA_H
+
+#include <stddef.h>
+
+//Alignment of everything handed out by the arena
+#define CACHE_LINE_SIZE 64
+
+//Bytes reserved from the system at a time
+#define SLAB_SIZE (1 << 20)
+
+//Blocks of up to this many cache lines are kept for reuse once recycled
+#define ARENA_FREE_LISTS 64
+
+/*
+ * Level Arena class
+ *   A slab allocator that owns the storage of every Level and child
+ *   array in one page table. Memory is reserved from the system a slab
+ *   at a time and handed out by bumping a cursor, every block comes back
+ *   zeroed and cache line aligned, and all of it is returned in one call.
+ *   Small blocks that are no longer needed can be recycled, and are then
+ *   handed out again to requests of the same size.
+*/
+class LevelArena {
+    public:
+        LevelArena();
+        ~LevelArena();
+
+        void* allocate(size_t bytes);
+        void recycle(void* block, size_t bytes);
+        void release();
+
+        size_t getBytesReserved();
+        size_t getBytesUsed();
+
+    private:
+        /**
+         * This Struct sits at the start of every slab and links it to the
+         * slab reserved before it, so they can all be returned on release
+         */
+        struct Slab {
+            Slab* next;
+            size_t size;
+        };
+
+        Slab* slabs;
+        char* cursor;
+        char* limit;
+        size_t bytesReserved;
+        size_t bytesUsed;
+        void* freeBlocks[ARENA_FREE_LISTS]; //Recycled blocks of i + 1 cache lines, linked through their first word
+
+        Slab* reserveSlab(size_t size);
+};
+
+#endif
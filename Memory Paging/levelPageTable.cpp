@@ -0,0 +1,346 @@
+//This is the work of Teddy Barker
+
+#include "levelPageTable.h"
+#include <new>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+//Entries in a compact level of each kind, a dense level has one per index
+static const unsigned int kindCapacity[] = { 4, 16, 48 };
+
+/**
+ * Returns the first kind from this one on that is smaller than a dense level of size entries
+ */
+static LevelKind fittingKind(LevelKind kind, unsigned int size) {
+    while (kind != LEVEL_DENSE && kindCapacity[kind] >= size)
+        kind = (LevelKind) (kind + 1);
+    return kind;
+}
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+LevelPageTable::LevelPageTable(unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits, bool adaptive)
+    : PageTable(levelCount, entryCount, addressBits) {
+    this->adaptive = adaptive;
+
+    hugePageDepth = 0;
+    hugePageThreshold = 0;
+    hugePageFrames = 0;
+    hugePagesMapped = 0;
+
+    levelsAllocated = 0;
+    entriesAllocated = 0;
+
+    //Allocating new root level
+    root = allocateLevel(0, this->entryCount[0]);
+}
+
+LevelPageTable::~LevelPageTable() {
+    //Every level lives in the arena, so they all go at once
+    arena.release();
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Returns the integer for the physical frame number for this address, walking from the root
+ */
+unsigned int LevelPageTable::recordPageAccess(uint64_t address, bool &flag) {
+    return recordPageAccess(address, root, flag);
+}
+
+/**
+ * This is the bread and butter.
+ * Returns the integer for the physical frame number for this vpn
+ *  it also tracks pagetable hit or miss using the flag
+ */
+unsigned int LevelPageTable::recordPageAccess(uint64_t address, Level* level, bool &flag) {
+    //Walk down from this level, adding any level that is missing, until the leaf level is reached
+    while(level->depth < levelCount - 1) {
+        unsigned int masked = extractPageNumberFromAddress(address, bitMaskAry[level->depth], shiftAry[level->depth]);
+        level = nextLevel(level, masked);
+    }
+
+    //This is the leaf level, so handle the PFN assignment here
+    unsigned int masked = extractPageNumberFromAddress(address, bitMaskAry[level->depth], shiftAry[level->depth]);
+    return mapPage(level, masked, (address & getAddressMask()) >> shiftAry[level->depth], flag);
+}
+
+/**
+ * Unmaps the leaf entry of an evicted page. A compact level keeps its entry,
+ * entries only ever move when a level grows
+ */
+void LevelPageTable::unmapPage(const FrameOwner& owner) {
+    Level* level = owner.level;
+    int slot = (level->kind == LEVEL_DENSE) ? (int) owner.index : findSlot(level, owner.index);
+    level->pfnAry[slot] = INVALID_PFN;
+}
+
+/**
+ * Lets levels at this depth become huge pages once threshold pages below them are mapped,
+ * half of their pages when threshold is 0. The root can not be promoted
+ */
+void LevelPageTable::enableHugePages(unsigned int depth, unsigned int threshold) {
+    hugePageDepth = depth;
+
+    //A huge page spans every page index from its depth down
+    hugePageFrames = 1u << (shiftAry[depth - 1] - shiftAry[levelCount - 1]);
+    hugePageThreshold = (threshold > 0) ? threshold : hugePageFrames / 2;
+}
+
+/**
+ * Promotes a level at the huge page depth to a huge page, mapping its whole range
+ * to the next run of frames aligned to its size. The frames of the small pages it
+ * held are released
+ */
+void LevelPageTable::promote(Level* level) {
+    unsigned int pfn = (nextAvailablePFN + hugePageFrames - 1) & ~(hugePageFrames - 1);
+    nextAvailablePFN = pfn + hugePageFrames;
+    framesAllocated += hugePageFrames - level->pagesMapped;
+
+    level->hugePfn = pfn;
+    hugePagesMapped++;
+}
+
+/**
+ * Getter for the depth of the levels that can become huge pages, 0 without huge pages
+ */
+unsigned int LevelPageTable::getHugePageDepth() {
+    return hugePageDepth;
+}
+
+/**
+ * Getter for the pages a level needs mapped below it to be promoted
+ */
+unsigned int LevelPageTable::getHugePageThreshold() {
+    return hugePageThreshold;
+}
+
+/**
+ * Getter for the frames, or small pages, in a huge page
+ */
+unsigned int LevelPageTable::getHugePageFrames() {
+    return hugePageFrames;
+}
+
+/**
+ * Getter for the number of levels promoted to huge pages
+ */
+unsigned int LevelPageTable::getHugePagesMapped() {
+    return hugePagesMapped;
+}
+
+/**
+ * Adds the level below entry index of this level, called when a walk finds it missing
+ */
+Level* LevelPageTable::addLevel(Level* level, unsigned int index) {
+    Level* next = allocateLevel(level->depth + 1, entryCount[level->depth + 1]);
+
+    //Find the slot first, growing a compact level moves its entries
+    int slot = insertSlot(level, index);
+    level->nextPtr[slot] = next;
+    return next;
+}
+
+/**
+ * Getter for the total page table entries, the entries of every level whether they are mapped or not
+ */
+unsigned long LevelPageTable::getTotalPageTableEntries() {
+    return entriesAllocated;
+}
+
+/**
+ * Getter for the number of levels allocated, the root included
+ */
+unsigned long LevelPageTable::getLevelsAllocated() {
+    return levelsAllocated;
+}
+
+/**
+ * Getter for the bytes the levels of this page table are using
+ */
+size_t LevelPageTable::getBytesUsed() {
+    return arena.getBytesUsed();
+}
+
+/**
+ * Helper Function to allocate a level and its entries from the arena.
+ * Levels start as the smallest compact kind that fits when the table is adaptive, dense otherwise
+ */
+Level* LevelPageTable::allocateLevel(unsigned int depth, unsigned int size) {
+    Level* level = new (arena.allocate(sizeof(Level))) Level(depth, size, this, nullptr, nullptr);
+    allocateEntries(level, adaptive ? fittingKind(LEVEL_NODE4, size) : LEVEL_DENSE);
+    levelsAllocated++;
+    return level;
+}
+
+/**
+ * Helper Function to give a level the entries of this kind in one block from the arena.
+ * The last level gets a PFN array, the others a zeroed child array, and a dense
+ * PFN array starts unmapped. Compact kinds keep their keys or index after the entries
+ */
+void LevelPageTable::allocateEntries(Level* level, LevelKind kind) {
+    level->kind = kind;
+    level->count = 0;
+    level->nextPtr = nullptr;
+    level->pfnAry = nullptr;
+    level->keys = nullptr;
+    level->childIndex = nullptr;
+
+    char* block = (char*) arena.allocate(entryBytes(level, kind));
+    unsigned int slots = slotCount(level);
+    entriesAllocated += slots;
+    size_t valueBytes;
+
+    if (level->depth == levelCount - 1) {
+        level->pfnAry = (unsigned int*) block;
+        valueBytes = slots * sizeof(unsigned int);
+        if (kind == LEVEL_DENSE)
+            memset(level->pfnAry, 0xFF, valueBytes); //Every byte of INVALID_PFN is 0xFF
+    } else {
+        level->nextPtr = (Level**) block;
+        valueBytes = slots * sizeof(Level*);
+    }
+
+    if (kind == LEVEL_NODE4 || kind == LEVEL_NODE16)
+        level->keys = (unsigned int*) (block + valueBytes);
+    else if (kind == LEVEL_NODE48)
+        level->childIndex = (unsigned char*) (block + valueBytes);
+}
+
+/**
+ * Helper Function for the bytes the entries of a level of this kind take
+ */
+size_t LevelPageTable::entryBytes(Level* level, LevelKind kind) {
+    size_t slots = (kind == LEVEL_DENSE) ? level->size : kindCapacity[kind];
+    size_t bytes = slots * ((level->depth == levelCount - 1) ? sizeof(unsigned int) : sizeof(Level*));
+
+    if (kind == LEVEL_NODE4 || kind == LEVEL_NODE16)
+        bytes += slots * sizeof(unsigned int);
+    else if (kind == LEVEL_NODE48)
+        bytes += level->size;
+    return bytes;
+}
+
+/**
+ * Helper Function for the number of entries a level has room for
+ */
+unsigned int LevelPageTable::slotCount(Level* level) {
+    return (level->kind == LEVEL_DENSE) ? level->size : kindCapacity[level->kind];
+}
+
+/**
+ * Returns the entry of a compact level that holds index, or LEVEL_NO_SLOT if it has none
+ */
+int LevelPageTable::findSlot(Level* level, unsigned int index) {
+    switch (level->kind) {
+        case LEVEL_NODE48:
+            return (int) level->childIndex[index] - 1; //0 means no entry, which is LEVEL_NO_SLOT
+#if defined(__SSE2__)
+        case LEVEL_NODE16: {
+            //Compare all 16 keys at once, keeping the bits of the keys in use
+            __m128i key = _mm_set1_epi32(index);
+            int hits = 0;
+            for (int i = 0; i < 16; i += 4) {
+                __m128i lanes = _mm_loadu_si128((const __m128i*) (level->keys + i));
+                hits |= _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lanes, key))) << i;
+            }
+            hits &= (1 << level->count) - 1;
+            return hits ? __builtin_ctz(hits) : LEVEL_NO_SLOT;
+        }
+#endif
+        default:
+            //The keys are sorted, so the search can stop at the first larger one
+            for (unsigned int i = 0; i < level->count; i++) {
+                if (level->keys[i] == index)
+                    return i;
+                if (level->keys[i] > index)
+                    break;
+            }
+            return LEVEL_NO_SLOT;
+    }
+}
+
+/**
+ * Returns the entry index should be stored in, growing a full compact level first.
+ * A compact level gives index a new entry, keeping its keys sorted
+ */
+int LevelPageTable::insertSlot(Level* level, unsigned int index) {
+    if (level->kind != LEVEL_DENSE && level->count == kindCapacity[level->kind])
+        growLevel(level);
+
+    if (level->kind == LEVEL_DENSE)
+        return index;
+
+    if (level->kind == LEVEL_NODE48) {
+        int slot = level->count++;
+        level->childIndex[index] = slot + 1;
+        return slot;
+    }
+
+    //Shift the larger keys and their entries up by one to make room
+    int slot = level->count++;
+    while (slot > 0 && level->keys[slot - 1] > index) {
+        level->keys[slot] = level->keys[slot - 1];
+        if (level->nextPtr != nullptr)
+            level->nextPtr[slot] = level->nextPtr[slot - 1];
+        else
+            level->pfnAry[slot] = level->pfnAry[slot - 1];
+        slot--;
+    }
+    level->keys[slot] = index;
+    return slot;
+}
+
+/**
+ * Moves a full compact level into the next kind that fits and recycles its old entries
+ */
+void LevelPageTable::growLevel(Level* level) {
+    Level old = *level;
+    void* oldBlock = (old.nextPtr != nullptr) ? (void*) old.nextPtr : (void*) old.pfnAry;
+
+    allocateEntries(level, fittingKind((LevelKind) (old.kind + 1), level->size));
+
+    //Insert every entry of the old level in index order
+    for (unsigned int i = 0; i < ((old.kind == LEVEL_NODE48) ? old.size : old.count); i++) {
+        unsigned int index = i;
+        int oldSlot = i;
+        if (old.kind == LEVEL_NODE48) {
+            if (old.childIndex[i] == 0)
+                continue;
+            oldSlot = old.childIndex[i] - 1;
+        } else {
+            index = old.keys[i];
+        }
+
+        int slot = insertSlot(level, index);
+        if (level->nextPtr != nullptr)
+            level->nextPtr[slot] = old.nextPtr[oldSlot];
+        else
+            level->pfnAry[slot] = old.pfnAry[oldSlot];
+    }
+
+    arena.recycle(oldBlock, entryBytes(&old, old.kind));
+    entriesAllocated -= kindCapacity[old.kind];
+}
+
+/**
+ * Getter for root level
+ */
+Level* LevelPageTable::getRoot() {
+    return root;
+}
+
+/**
+ * Getter for the backend, the radix tree of levels with or without adaptive levels
+ */
+PageTableBackend LevelPageTable::getBackend() {
+    return adaptive ? BACKEND_ADAPTIVE : BACKEND_LEVELS;
+}
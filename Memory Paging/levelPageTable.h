@@ -0,0 +1,129 @@
+//This is the work of Teddy Barker
+
+#ifndef LEVELPAGETABLE_H
+#define LEVELPAGETABLE_H
+
+#include "pageTable.h"
+#include "level.h"
+#include "levelArena.h"
+
+/*
+ * Level Page Table class
+ *   The radix tree backend, a pointer to the root level (Level 0) object
+ *   and an arena holding every level below it. A walk follows one child
+ *   pointer per level down to the leaf level, which holds the PFNs.
+ *
+ *   An adaptive table starts every level as a compact node of 4 entries
+ *   and grows it to 16, 48 and then a dense array as it fills, the way
+ *   an adaptive radix tree does, so sparse levels only pay for the
+ *   entries they use. Dense levels keep the single array lookup.
+ *
+ *   With huge pages, a level at the huge page depth is promoted once
+ *   enough pages below it are mapped. Its whole range then maps to one
+ *   aligned run of frames, and walks stop there instead of at the leaf.
+ *   The levels below it stay in the tree, no walk reaches them again.
+ *
+ *   An evicted page leaves its leaf entry unmapped, a compact level keeps
+ *   the entry for its index so the page can be mapped there again.
+ *
+ *   The levels and entries are counted as they are allocated, so the
+ *   totals can be read at any point of a run without walking the tree.
+*/
+class LevelPageTable : public PageTable {
+    public:
+        LevelPageTable(unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits, bool adaptive);
+        ~LevelPageTable();
+
+        unsigned int recordPageAccess(uint64_t address, bool &flag);
+        unsigned int recordPageAccess(uint64_t address, Level * level, bool &flag);
+
+        //Single steps of a page walk, shared by recordPageAccess and the page walkers
+        Level* nextLevel(Level* level, unsigned int index);
+        unsigned int mapPage(Level* level, unsigned int index, uint64_t vpn, bool &flag);
+
+        void enableHugePages(unsigned int depth, unsigned int threshold);
+        void promote(Level* level);
+        unsigned int getHugePageDepth();
+        unsigned int getHugePageThreshold();
+        unsigned int getHugePageFrames();
+        unsigned int getHugePagesMapped();
+
+        Level* getRoot();
+        PageTableBackend getBackend();
+        unsigned long getTotalPageTableEntries();
+        unsigned long getLevelsAllocated();
+        size_t getBytesUsed();
+        void unmapPage(const FrameOwner& owner);
+
+    private:
+        Level* root;
+        LevelArena arena;
+        bool adaptive;
+        unsigned long levelsAllocated;
+        unsigned long entriesAllocated; //Entries every level has room for, whether they are in use or not
+
+        //Huge pages
+        unsigned int hugePageDepth; //Depth of the levels that can be promoted, 0 for none
+        unsigned int hugePageThreshold;
+        unsigned int hugePageFrames;
+        unsigned int hugePagesMapped;
+
+        Level* allocateLevel(unsigned int depth, unsigned int size);
+        Level* addLevel(Level* level, unsigned int index);
+
+        //Compact levels
+        int findSlot(Level* level, unsigned int index);
+        int insertSlot(Level* level, unsigned int index);
+        void growLevel(Level* level);
+        void allocateEntries(Level* level, LevelKind kind);
+        size_t entryBytes(Level* level, LevelKind kind);
+        unsigned int slotCount(Level* level);
+};
+
+/**
+ * Returns the level below entry index of this level, adding it if it is missing.
+ * Defined here so that the walk loops can inline it
+ */
+inline Level* LevelPageTable::nextLevel(Level* level, unsigned int index) {
+    Level* next;
+    if(level->kind == LEVEL_DENSE) {
+        next = level->nextPtr[index];
+    } else {
+        int slot = findSlot(level, index);
+        next = (slot == LEVEL_NO_SLOT) ? nullptr : level->nextPtr[slot];
+    }
+
+    if(next == nullptr)
+        next = addLevel(level, index);
+    return next;
+}
+
+/**
+ * Returns the PFN in entry index of this leaf level, mapping a frame to vpn
+ * if there is none yet. The flag is set on a pagetable hit
+ */
+inline unsigned int LevelPageTable::mapPage(Level* level, unsigned int index, uint64_t vpn, bool &flag) {
+    unsigned int entry = index;
+    if(level->kind != LEVEL_DENSE) {
+        int slot = findSlot(level, index);
+        if(slot == LEVEL_NO_SLOT) {
+            //Give the index an entry of its own and map it below
+            slot = insertSlot(level, index);
+            level->pfnAry[slot] = INVALID_PFN;
+        }
+        entry = slot;
+    }
+
+    unsigned int& pfn = level->pfnAry[entry];
+    if(pfn == INVALID_PFN) {
+        //Store the next available PFN straight in the leaf entry, an eviction only ever unmaps a mapped entry
+        pfn = allocateFrame(vpn, level, index);
+        flag = false;
+        return pfn;
+    }
+
+    flag = true;
+    return pfn;
+}
+
+#endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <inttypes.h>
 #include "log.h"
 
 /* Handle C++ namespaces, ignore if compiled in C 
@@ -13,8 +14,8 @@ using namespace std;
  * @brief Print out a number in hex, one per line
  * @param number 
  */
-void hexnum(uint32_t number) {
-  printf("%08X\n", number);
+void hexnum(uint64_t number) {
+  printf("%08" PRIX64 "\n", number);
   fflush(stdout);
 }
 
@@ -24,11 +25,11 @@ void hexnum(uint32_t number) {
  * @param levels - Number of levels
  * @param masks - Pointer to array of bitmasks
  */
-void log_bitmasks(int levels, uint32_t *masks) {
+void log_bitmasks(int levels, uint64_t *masks) {
   printf("Bitmasks\n");
   for (int idx = 0; idx < levels; idx++) 
     /* show mask entry and move to next */
-    printf("level %d mask %08X\n", idx, masks[idx]);
+    printf("level %d mask %08" PRIX64 "\n", idx, masks[idx]);
 
   fflush(stdout);
 }
@@ -43,8 +44,8 @@ void log_bitmasks(int levels, uint32_t *masks) {
  * @param src 
  * @param dest 
  */
-void log_virtualAddr2physicalAddr(uint32_t src, uint32_t dest) {
-  fprintf(stdout, "%08X -> %08X\n", src, dest);
+void log_virtualAddr2physicalAddr(uint64_t src, uint64_t dest) {
+  fprintf(stdout, "%08" PRIX64 " -> %08" PRIX64 "\n", src, dest);
   fflush(stdout);
 }
 
@@ -67,9 +68,9 @@ void log_virtualAddr2physicalAddr(uint32_t src, uint32_t dest) {
  * @param tlbhit 
  * @param pthit 
  */
-void log_va2pa_ATC_PTwalk(uint32_t src, uint32_t dest, bool tlbhit, bool pthit) {
+void log_va2pa_ATC_PTwalk(uint64_t src, uint64_t dest, bool tlbhit, bool pthit) {
   
-  fprintf(stdout, "%08X -> %08X, ", src, dest);
+  fprintf(stdout, "%08" PRIX64 " -> %08" PRIX64 ", ", src, dest);
 
   if (tlbhit)
     fprintf(stdout, "tlb hit\n");
@@ -132,3 +133,321 @@ void log_summary(unsigned int page_size,
   fflush(stdout);
 }
 
+/**
+ * @brief Write out one TLB of the hierarchy, if it saw any lookups
+ */
+static void log_tlblevel(const char *name, unsigned long int lookups, unsigned long int hits) {
+  if (lookups == 0)
+    return;
+
+  printf("%s lookups: %lu, hits: %lu, hit percentage: %.2f%%\n", name,
+         lookups, hits, (double) hits / (double) lookups * 100.0);
+}
+
+/**
+ * @brief Write out the lookups and hits of every TLB in the hierarchy,
+ *        to follow the summary when there are L1 TLBs. A TLB that
+ *        saw no lookups is left out.
+ * 
+ * @param itlbLookups - Number of lookups in the L1 instruction TLB
+ * @param itlbHits - Number of those found in the L1 instruction TLB
+ * @param dtlbLookups - Number of lookups in the L1 data TLB
+ * @param dtlbHits - Number of those found in the L1 data TLB
+ * @param l2Lookups - Number of lookups that reached the unified L2 TLB
+ * @param l2Hits - Number of those found in the unified L2 TLB
+ */
+void log_tlblevels(unsigned long int itlbLookups, unsigned long int itlbHits,
+                   unsigned long int dtlbLookups, unsigned long int dtlbHits,
+                   unsigned long int l2Lookups, unsigned long int l2Hits) {
+  log_tlblevel("L1 iTLB", itlbLookups, itlbHits);
+  log_tlblevel("L1 dTLB", dtlbLookups, dtlbHits);
+  log_tlblevel("L2 TLB", l2Lookups, l2Hits);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the translations of each page size, to follow the
+ *        summary when there are huge pages, with the share of them that
+ *        the TLBs held.
+ * 
+ * @param pageSize - Number of bytes per small page
+ * @param addresses - Number of addresses translated through a small page
+ * @param cacheHits - Number of those found in the TLB
+ * @param hugePageSize - Number of bytes per huge page
+ * @param hugeAddresses - Number of addresses translated through a huge page
+ * @param hugeCacheHits - Number of those found in the TLB
+ * @param hugePages - Number of huge pages mapped
+ */
+void log_pagesizes(unsigned long int pageSize, unsigned long int addresses, unsigned long int cacheHits,
+                   unsigned long int hugePageSize, unsigned long int hugeAddresses,
+                   unsigned long int hugeCacheHits, unsigned int hugePages) {
+  double hit_percent = addresses ? (double) cacheHits / (double) addresses * 100.0 : 0.0;
+  printf("Small pages (%lu bytes): addresses: %lu, cache hits: %lu, hit percentage: %.2f%%\n",
+         pageSize, addresses, cacheHits, hit_percent);
+
+  hit_percent = hugeAddresses ? (double) hugeCacheHits / (double) hugeAddresses * 100.0 : 0.0;
+  printf("Huge pages (%lu bytes): addresses: %lu, cache hits: %lu, hit percentage: %.2f%%, pages mapped: %u\n",
+         hugePageSize, hugeAddresses, hugeCacheHits, hit_percent, hugePages);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the paging of bounded physical memory, to follow the
+ *        summary when there is a frame limit. Every page table miss is a
+ *        page fault, and once every frame is in use each one evicts a page.
+ * 
+ * @param frames - Number of frames of physical memory
+ * @param pageFaults - Number of addresses whose page was not mapped
+ * @param evictions - Number of pages evicted to make room
+ * @param addresses - Number of addresses processed
+ */
+void log_frames(unsigned int frames, unsigned long int pageFaults, unsigned long int evictions,
+                unsigned long int addresses) {
+  double fault_percent = addresses ? (double) pageFaults / (double) addresses * 100.0 : 0.0;
+  printf("Physical frames: %u, page faults: %lu, fault percentage: %.2f%%, evictions: %lu\n",
+         frames, pageFaults, fault_percent, evictions);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the page walk cache, to follow the summary when there
+ *        is one. Each cached level gets a line with the walks that
+ *        started from it, then the totals give the walks that missed
+ *        every TLB and the page table entries they did not have to read.
+ * 
+ * @param cacheLevels - Number of upper levels given a cache size
+ * @param entries - entries[i] is the size of the cache of level i, 0 for none
+ * @param hits - hits[i] is the walks that started below level i, skipping i + 1 levels
+ * @param walks - Number of page walks
+ * @param stepsSaved - Number of page table entries the cache saved reading
+ * @param steps - Number of page table entries the walks would read without it
+ */
+void log_walkcache(unsigned int cacheLevels, unsigned int *entries, unsigned long int *hits,
+                   unsigned long int walks, unsigned long int stepsSaved, unsigned long int steps) {
+  for (unsigned int i = 0; i < cacheLevels; i++) {
+    if (entries[i] == 0)
+      continue;
+    double hit_percent = walks ? (double) hits[i] / (double) walks * 100.0 : 0.0;
+    printf("Walk cache level %u entries: %u, hits: %lu, hit percentage: %.2f%%, levels skipped per hit: %u\n",
+           i, entries[i], hits[i], hit_percent, i + 1);
+  }
+
+  double saved_percent = steps ? (double) stepsSaved / (double) steps * 100.0 : 0.0;
+  printf("Page walks: %lu, walk steps: %lu, steps saved: %lu, saved percentage: %.2f%%\n",
+         walks, steps, stepsSaved, saved_percent);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the hit rate a fully associative LRU TLB would have
+ *        at every capacity from 1 to maxCapacity, one line per capacity.
+ * 
+ * @param maxCapacity - Largest capacity on the curve
+ * @param hits - hits[c] is the number of hits at capacity c (0 < c <= maxCapacity)
+ * @param addresses - Number of addresses processed
+ */
+void log_hitratecurve(unsigned int maxCapacity, unsigned long int *hits,
+                      unsigned long int addresses) {
+  printf("TLB hit rate by capacity (fully associative, LRU)\n");
+  for (unsigned int capacity = 1; capacity <= maxCapacity; capacity++) {
+    double hit_percent = addresses ? (double) hits[capacity] / (double) addresses * 100.0 : 0.0;
+    printf("Capacity %u: hits %lu, hit percentage %.2f%%\n", capacity, hits[capacity], hit_percent);
+  }
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the summary of a sampled run. The TLB hit rate is
+ *        estimated from the sample units, with the half width of its 95%
+ *        confidence interval, or none when there were too few units. The
+ *        misses, frames and page table are exact, as functional warming
+ *        kept the page table up to date over the whole trace, and the
+ *        page hits are the rest of the addresses.
+ * 
+ * @param page_size - Number of bytes per page
+ * @param addresses - Number of addresses in the trace
+ * @param detailed - Number of those translated in detail, units and their warming
+ * @param units - Number of sample units measured
+ * @param unitSize - Number of addresses in a unit
+ * @param cacheHitRate - Estimated share of addresses found in the TLB
+ * @param halfWidth - Half width of its confidence interval, negative for none
+ * @param misses - Number of addresses whose page was not mapped
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_sampled(unsigned int page_size, unsigned long int addresses, unsigned long int detailed,
+                 unsigned long int units, unsigned long int unitSize, double cacheHitRate,
+                 double halfWidth, unsigned long int misses, unsigned int frames_used,
+                 unsigned long int pgtableEntries) {
+  printf("Page size: %d bytes\n", page_size);
+  double detailed_percent = addresses ? (double) detailed / (double) addresses * 100.0 : 0.0;
+  printf("Addresses processed: %lu, simulated in detail: %lu (%.2f%%), sample units: %lu of %lu addresses\n",
+         addresses, detailed, detailed_percent, units, unitSize);
+
+  /* The page hits are what is left once the misses are taken out */
+  double miss_rate = addresses ? (double) misses / (double) addresses : 0.0;
+  double page_rate = 1.0 - cacheHitRate - miss_rate;
+  if (page_rate < 0)
+    page_rate = 0;
+  if (units == 0) {
+    printf("No sample units, the trace is shorter than a sampling period\n");
+  } else if (halfWidth < 0) {
+    printf("Estimated cache hit percentage: %.2f%%, too few units for a confidence interval\n", cacheHitRate * 100.0);
+    printf("Estimated cache miss percentage: %.2f%%\n", (1.0 - cacheHitRate) * 100.0);
+    printf("Estimated page hit percentage: %.2f%%\n", page_rate * 100.0);
+  } else {
+    printf("Estimated cache hit percentage: %.2f%% +/- %.2f%% (95%% confidence)\n", cacheHitRate * 100.0, halfWidth * 100.0);
+    printf("Estimated cache miss percentage: %.2f%% +/- %.2f%% (95%% confidence)\n", (1.0 - cacheHitRate) * 100.0, halfWidth * 100.0);
+    printf("Estimated page hit percentage: %.2f%% +/- %.2f%% (95%% confidence)\n", page_rate * 100.0, halfWidth * 100.0);
+  }
+  printf("Misses: %lu, miss percentage: %.2f%%\n", misses, miss_rate * 100.0);
+  printf("Frames allocated: %d\n", frames_used);
+  printf("Number of page table entries: %ld\n", pgtableEntries);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out one interval of a run as a single tab separated row,
+ *        after a header row for the first, so the rows form a time series
+ *        of how the TLB and page table warm up. The hits are those of the
+ *        interval alone, the page table is as it stands at its end.
+ * 
+ * @param header - Write the header row first
+ * @param addresses - Number of addresses processed by the end of the interval
+ * @param intervalAddresses - Number of addresses in the interval
+ * @param cacheHits - Number of those found in the TLB
+ * @param pageTableHits - Number of those whose page was mapped
+ * @param frames_used - Number of frames allocated
+ * @param pgtableLevels - Number of page table levels allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_interval(bool header, unsigned long int addresses, unsigned long int intervalAddresses,
+                  unsigned long int cacheHits, unsigned long int pageTableHits, unsigned int frames_used,
+                  unsigned long int pgtableLevels, unsigned long int pgtableEntries) {
+  if (header)
+    printf("Addresses\tCache hits\tPage hits\tMisses\tHit percentage\tFrames\tPage table levels\tPage table entries\n");
+
+  unsigned long int totalhits = cacheHits + pageTableHits;
+  double hit_percent = intervalAddresses ? (double) totalhits / (double) intervalAddresses * 100.0 : 0.0;
+  printf("%lu\t%lu\t%lu\t%lu\t%.2f%%\t%u\t%lu\t%lu\n", addresses, cacheHits, pageTableHits,
+         intervalAddresses - totalhits, hit_percent, frames_used, pgtableLevels, pgtableEntries);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the summary of one configuration of a sweep as a
+ *        single tab separated row, after a header row for the first.
+ * 
+ * @param header - Write the header row first
+ * @param config - The configuration, as written in the sweep file
+ * @param page_size - Number of bytes per page
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB
+ * @param pageTableHits - Number of times a page was mapped
+ * @param addresses - Number of addresses processed
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ * @param pgtableBytes - Bytes of memory the page table reserved
+ * @param seconds - Time the translations took
+ */
+void log_sweeprow(bool header, const char *config, unsigned int page_size,
+                  unsigned long int cacheHits, unsigned long int pageTableHits,
+                  unsigned long int addresses, unsigned int frames_used,
+                  unsigned long int pgtableEntries, unsigned long int pgtableBytes,
+                  double seconds) {
+  if (header)
+    printf("Configuration\tPage size\tAddresses\tCache hits\tPage hits\tMisses\tHit percentage\tFrames\tPage table entries\tPage table bytes\tSeconds\n");
+
+  unsigned long int totalhits = cacheHits + pageTableHits;
+  double hit_percent = addresses ? (double) totalhits / (double) addresses * 100.0 : 0.0;
+  printf("%s\t%u\t%lu\t%lu\t%lu\t%lu\t%.2f%%\t%u\t%lu\t%lu\t%.3f\n", config, page_size, addresses,
+         cacheHits, pageTableHits, addresses - totalhits, hit_percent, frames_used, pgtableEntries,
+         pgtableBytes, seconds);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the summary of one process in its own address space
+ *        on a single line, ahead of the summary of the whole system.
+ * 
+ * @param proc - The process, p2AddrTr.proc
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB
+ * @param pageTableHits - Number of times a page was mapped
+ * @param addresses - Number of addresses processed
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_processsummary(unsigned int proc, unsigned long int cacheHits,
+                        unsigned long int pageTableHits, unsigned long int addresses,
+                        unsigned int frames_used, unsigned long int pgtableEntries) {
+  unsigned long int totalhits = cacheHits + pageTableHits;
+  double hit_percent = addresses ? (double) totalhits / (double) addresses * 100.0 : 0.0;
+  printf("Process %u: addresses %lu, cache hits %lu, page hits %lu, misses %lu, hit percentage %.2f%%, frames %u, page table entries %lu\n",
+         proc, addresses, cacheHits, pageTableHits, addresses - totalhits, hit_percent, frames_used, pgtableEntries);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out the TLB counts of one chunk of a chunked run on a
+ *        single line, ahead of the summary of the whole trace.
+ * 
+ * @param chunk - The chunk, numbered from 0 in trace order
+ * @param firstRecord - Number of records before the chunk
+ * @param addresses - Number of addresses in the chunk
+ * @param warmupAddresses - Number of addresses before it translated to warm its TLBs
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB, after the warm-up
+ */
+void log_chunksummary(unsigned int chunk, unsigned long int firstRecord, unsigned long int addresses,
+                      unsigned long int warmupAddresses, unsigned long int cacheHits) {
+  double hit_percent = addresses ? (double) cacheHits / (double) addresses * 100.0 : 0.0;
+  printf("Chunk %u: first record %lu, addresses %lu, warm-up addresses %lu, cache hits %lu, cache hit percentage %.2f%%\n",
+         chunk, firstRecord, addresses, warmupAddresses, cacheHits, hit_percent);
+
+  fflush(stdout);
+}
+
+/**
+ * @brief Write out how far the counts of a chunked run are from those
+ *        of a serial run of the same trace, each as the difference of
+ *        the chunked count and its share of the addresses, with the
+ *        time each run took.
+ * 
+ * @param addresses - Number of addresses processed
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB by the chunked run
+ * @param serialCacheHits - Number of those found by the serial run
+ * @param pageTableHits - Number of page hits of the chunked run
+ * @param serialPageTableHits - Number of page hits of the serial run
+ * @param misses - Number of misses of the chunked run
+ * @param serialMisses - Number of misses of the serial run
+ * @param seconds - Time the chunked run took
+ * @param serialSeconds - Time the serial run took
+ */
+void log_chunkerror(unsigned long int addresses, unsigned long int cacheHits, unsigned long int serialCacheHits,
+                    unsigned long int pageTableHits, unsigned long int serialPageTableHits,
+                    unsigned long int misses, unsigned long int serialMisses, double seconds,
+                    double mergeSeconds, double serialSeconds) {
+  const char *names[] = { "Cache hits", "Page hits", "Misses" };
+  unsigned long int counts[] = { cacheHits, pageTableHits, misses };
+  unsigned long int serialCounts[] = { serialCacheHits, serialPageTableHits, serialMisses };
+
+  for (int i = 0; i < 3; i++) {
+    long int error = (long int) counts[i] - (long int) serialCounts[i];
+    double error_percent = addresses ? (double) error / (double) addresses * 100.0 : 0.0;
+    printf("%s: chunked %lu, serial %lu, error %ld (%+.4f%%)\n", names[i], counts[i], serialCounts[i],
+           error, error_percent);
+  }
+  printf("Chunked seconds: %.3f, serial seconds: %.3f, speedup: %.2fx\n", seconds, serialSeconds,
+         seconds > 0 ? serialSeconds / seconds : 0.0);
+  printf("Serial merge seconds: %.3f (%.2f%% of the chunked run)\n", mergeSeconds,
+         seconds > 0 ? mergeSeconds / seconds * 100.0 : 0.0);
+
+  fflush(stdout);
+}
@@ -8,7 +8,7 @@
  *    in the 1999 C standard.
  *
  * C++ compilers
- *    uses uint32_t, unsigned 32 bit integer type, introduced in C++11,
+ *    uses uint32_t and uint64_t, unsigned 32 and 64 bit integer types, introduced in C++11,
  *    The defaults in the g++ compiler on edoras should be fine with this
  */
 
@@ -23,6 +23,21 @@
 /* C includes */
 #include <inttypes.h>
 #include <stdbool.h>
+/**
+ * @brief Write out the summary of one process in its own address space
+ *        on a single line, ahead of the summary of the whole system.
+ * 
+ * @param proc - The process, p2AddrTr.proc
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB
+ * @param pageTableHits - Number of times a page was mapped
+ * @param addresses - Number of addresses processed
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_processsummary(unsigned int proc, unsigned long int cacheHits,
+                        unsigned long int pageTableHits, unsigned long int addresses,
+                        unsigned int frames_used, unsigned long int pgtableEntries);
+
 #endif 
 
 /*
@@ -46,7 +61,7 @@ typedef struct {
  * @brief Print out a number in hex, one per line
  * @param number 
  */
-void hexnum(uint32_t number);
+void hexnum(uint64_t number);
 
 /**
  * @brief Print out bitmasks for all page table levels.
@@ -54,7 +69,7 @@ void hexnum(uint32_t number);
  * @param levels - Number of levels
  * @param masks - Pointer to array of bitmasks
  */
-void log_bitmasks(int levels, uint32_t *masks);
+void log_bitmasks(int levels, uint64_t *masks);
 
 /**
  * @brief Given a pair of numbers, output a line: 
@@ -66,7 +81,7 @@ void log_bitmasks(int levels, uint32_t *masks);
  * @param src 
  * @param dest 
  */
-void log_virtualAddr2physicalAddr(uint32_t src, uint32_t dest);
+void log_virtualAddr2physicalAddr(uint64_t src, uint64_t dest);
 
 /**
  * @brief Given a pair of addresses, hit or miss along the tlb 
@@ -87,7 +102,7 @@ void log_virtualAddr2physicalAddr(uint32_t src, uint32_t dest);
  * @param tlbhit 
  * @param pthit 
  */
-void log_va2pa_ATC_PTwalk(uint32_t src, uint32_t dest, bool tlbhit, bool pthit);
+void log_va2pa_ATC_PTwalk(uint64_t src, uint64_t dest, bool tlbhit, bool pthit);
 
 /**
  * @brief Write out page numbers and frame number
@@ -115,5 +130,193 @@ void log_summary(unsigned int page_size,
                     unsigned int addresses, unsigned int frames_used,
                     unsigned long int pgtableEntries);
 
+/**
+ * @brief Write out the lookups and hits of every TLB in the hierarchy,
+ *        to follow the summary when there are L1 TLBs. A TLB that
+ *        saw no lookups is left out.
+ * 
+ * @param itlbLookups - Number of lookups in the L1 instruction TLB
+ * @param itlbHits - Number of those found in the L1 instruction TLB
+ * @param dtlbLookups - Number of lookups in the L1 data TLB
+ * @param dtlbHits - Number of those found in the L1 data TLB
+ * @param l2Lookups - Number of lookups that reached the unified L2 TLB
+ * @param l2Hits - Number of those found in the unified L2 TLB
+ */
+void log_tlblevels(unsigned long int itlbLookups, unsigned long int itlbHits,
+                   unsigned long int dtlbLookups, unsigned long int dtlbHits,
+                   unsigned long int l2Lookups, unsigned long int l2Hits);
+
+/**
+ * @brief Write out the translations of each page size, to follow the
+ *        summary when there are huge pages, with the share of them that
+ *        the TLBs held.
+ * 
+ * @param pageSize - Number of bytes per small page
+ * @param addresses - Number of addresses translated through a small page
+ * @param cacheHits - Number of those found in the TLB
+ * @param hugePageSize - Number of bytes per huge page
+ * @param hugeAddresses - Number of addresses translated through a huge page
+ * @param hugeCacheHits - Number of those found in the TLB
+ * @param hugePages - Number of huge pages mapped
+ */
+void log_pagesizes(unsigned long int pageSize, unsigned long int addresses, unsigned long int cacheHits,
+                   unsigned long int hugePageSize, unsigned long int hugeAddresses,
+                   unsigned long int hugeCacheHits, unsigned int hugePages);
+
+/**
+ * @brief Write out the paging of bounded physical memory, to follow the
+ *        summary when there is a frame limit. Every page table miss is a
+ *        page fault, and once every frame is in use each one evicts a page.
+ * 
+ * @param frames - Number of frames of physical memory
+ * @param pageFaults - Number of addresses whose page was not mapped
+ * @param evictions - Number of pages evicted to make room
+ * @param addresses - Number of addresses processed
+ */
+void log_frames(unsigned int frames, unsigned long int pageFaults, unsigned long int evictions,
+                unsigned long int addresses);
+
+/**
+ * @brief Write out the page walk cache, to follow the summary when there
+ *        is one. Each cached level gets a line with the walks that
+ *        started from it, then the totals give the walks that missed
+ *        every TLB and the page table entries they did not have to read.
+ * 
+ * @param cacheLevels - Number of upper levels given a cache size
+ * @param entries - entries[i] is the size of the cache of level i, 0 for none
+ * @param hits - hits[i] is the walks that started below level i, skipping i + 1 levels
+ * @param walks - Number of page walks
+ * @param stepsSaved - Number of page table entries the cache saved reading
+ * @param steps - Number of page table entries the walks would read without it
+ */
+void log_walkcache(unsigned int cacheLevels, unsigned int *entries, unsigned long int *hits,
+                   unsigned long int walks, unsigned long int stepsSaved, unsigned long int steps);
+
+/**
+ * @brief Write out the hit rate a fully associative LRU TLB would have
+ *        at every capacity from 1 to maxCapacity, one line per capacity.
+ * 
+ * @param maxCapacity - Largest capacity on the curve
+ * @param hits - hits[c] is the number of hits at capacity c (0 < c <= maxCapacity)
+ * @param addresses - Number of addresses processed
+ */
+void log_hitratecurve(unsigned int maxCapacity, unsigned long int *hits,
+                      unsigned long int addresses);
+
+
+/**
+ * @brief Write out the summary of a sampled run. The TLB hit rate is
+ *        estimated from the sample units, with the half width of its 95%
+ *        confidence interval, or none when there were too few units, and
+ *        the TLB miss rate is its complement within the same interval. The
+ *        misses, frames and page table are exact, as functional warming
+ *        kept the page table up to date over the whole trace, and the
+ *        page hits are the rest of the addresses.
+ * 
+ * @param page_size - Number of bytes per page
+ * @param addresses - Number of addresses in the trace
+ * @param detailed - Number of those translated in detail, units and their warming
+ * @param units - Number of sample units measured
+ * @param unitSize - Number of addresses in a unit
+ * @param cacheHitRate - Estimated share of addresses found in the TLB
+ * @param halfWidth - Half width of its confidence interval, negative for none
+ * @param misses - Number of addresses whose page was not mapped
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_sampled(unsigned int page_size, unsigned long int addresses, unsigned long int detailed,
+                 unsigned long int units, unsigned long int unitSize, double cacheHitRate,
+                 double halfWidth, unsigned long int misses, unsigned int frames_used,
+                 unsigned long int pgtableEntries);
+
+/**
+ * @brief Write out one interval of a run as a single tab separated row,
+ *        after a header row for the first, so the rows form a time series
+ *        of how the TLB and page table warm up. The hits are those of the
+ *        interval alone, the page table is as it stands at its end.
+ * 
+ * @param header - Write the header row first
+ * @param addresses - Number of addresses processed by the end of the interval
+ * @param intervalAddresses - Number of addresses in the interval
+ * @param cacheHits - Number of those found in the TLB
+ * @param pageTableHits - Number of those whose page was mapped
+ * @param frames_used - Number of frames allocated
+ * @param pgtableLevels - Number of page table levels allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_interval(bool header, unsigned long int addresses, unsigned long int intervalAddresses,
+                  unsigned long int cacheHits, unsigned long int pageTableHits, unsigned int frames_used,
+                  unsigned long int pgtableLevels, unsigned long int pgtableEntries);
+
+/**
+ * @brief Write out the summary of one configuration of a sweep as a
+ *        single tab separated row, after a header row for the first.
+ * 
+ * @param header - Write the header row first
+ * @param config - The configuration, as written in the sweep file
+ * @param page_size - Number of bytes per page
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB
+ * @param pageTableHits - Number of times a page was mapped
+ * @param addresses - Number of addresses processed
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ * @param pgtableBytes - Bytes of memory the page table reserved
+ * @param seconds - Time the translations took
+ */
+void log_sweeprow(bool header, const char *config, unsigned int page_size,
+                  unsigned long int cacheHits, unsigned long int pageTableHits,
+                  unsigned long int addresses, unsigned int frames_used,
+                  unsigned long int pgtableEntries, unsigned long int pgtableBytes,
+                  double seconds);
+
+/**
+ * @brief Write out the summary of one process in its own address space
+ *        on a single line, ahead of the summary of the whole system.
+ * 
+ * @param proc - The process, p2AddrTr.proc
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB
+ * @param pageTableHits - Number of times a page was mapped
+ * @param addresses - Number of addresses processed
+ * @param frames_used - Number of frames allocated
+ * @param pgtableEntries - Total number of page table entries across all levels.
+ */
+void log_processsummary(unsigned int proc, unsigned long int cacheHits,
+                        unsigned long int pageTableHits, unsigned long int addresses,
+                        unsigned int frames_used, unsigned long int pgtableEntries);
+
+/**
+ * @brief Write out the TLB counts of one chunk of a chunked run on a
+ *        single line, ahead of the summary of the whole trace.
+ * 
+ * @param chunk - The chunk, numbered from 0 in trace order
+ * @param firstRecord - Number of records before the chunk
+ * @param addresses - Number of addresses in the chunk
+ * @param warmupAddresses - Number of addresses before it translated to warm its TLBs
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB, after the warm-up
+ */
+void log_chunksummary(unsigned int chunk, unsigned long int firstRecord, unsigned long int addresses,
+                      unsigned long int warmupAddresses, unsigned long int cacheHits);
+
+/**
+ * @brief Write out how far the counts of a chunked run are from those
+ *        of a serial run of the same trace, each as the difference of
+ *        the chunked count and its share of the addresses, with the
+ *        time each run took.
+ * 
+ * @param addresses - Number of addresses processed
+ * @param cacheHits - Number of vpn->pfn mapping found in the TLB by the chunked run
+ * @param serialCacheHits - Number of those found by the serial run
+ * @param pageTableHits - Number of page hits of the chunked run
+ * @param serialPageTableHits - Number of page hits of the serial run
+ * @param misses - Number of misses of the chunked run
+ * @param serialMisses - Number of misses of the serial run
+ * @param seconds - Time the chunked run took
+ * @param mergeSeconds - Time of the chunked run spent merging the page tables on one thread
+ * @param serialSeconds - Time the serial run took
+ */
+void log_chunkerror(unsigned long int addresses, unsigned long int cacheHits, unsigned long int serialCacheHits,
+                    unsigned long int pageTableHits, unsigned long int serialPageTableHits,
+                    unsigned long int misses, unsigned long int serialMisses, double seconds,
+                    double mergeSeconds, double serialSeconds);
 
 #endif
@@ -4,30 +4,91 @@
 #include <fstream>
 #include <cstdlib>
 #include <getopt.h>
+#include <vector>
+#include <thread>
+#include <chrono>
 #include "pageTable.h"
 #include "level.h"
 #include "tracereader.h"
+#include "traceSource.h"
+#include "stackDistance.h"
+#include "sweep.h"
+#include "addressSpaces.h"
 #include "log.h"
 #include "tlb.h"
+#include "simulator.h"
+#include "outputWriter.h"
+#include "resultWriter.h"
+#include "sampler.h"
+#include "traceChunks.h"
 
 #define NORMAL_EXIT 1
 
+//Records between progress reports when -p is given
+#define PROGRESS_INTERVAL (1 << 20)
+
+//Default width of the virtual addresses in a byu64 trace, a 4 level x86-64 walk
+#define DEFAULT_ADDRESS_BITS_64 48
+
 using namespace std;
 
 unsigned int* parseCommandLineArguments(int argc, char *argv[], int optind, unsigned int &levelCount);
+void reportProgress(size_t processed, size_t total);
+void reportInterval(Simulator& simulator, unsigned long* last, bool header);
+template <class RECORD>
+size_t simulateTrace(TraceSource& traceSource, Simulator& simulator, StackDistance* stackDistance, Sampler* sampler,
+                     OutputMode outputMode, ResultWriter* results, bool collapseRuns, unsigned int levelCount,
+                     size_t recordLimit, size_t recordTotal, size_t interval, bool showProgress);
+template <OutputMode MODE, class RECORD>
+void translateBatch(Simulator& simulator, OutputWriter& output, ResultWriter* results, const RECORD* batch,
+                    size_t batchCount, unsigned int levelCount, const uint64_t* vpns, const uint64_t* offsets,
+                    const unsigned int* pageIndices, size_t levelStride);
+template <class RECORD>
+void collapseBatch(Simulator& simulator, const RECORD* batch, size_t batchCount, const uint64_t* vpns,
+                   const uint64_t* offsets, const unsigned int* pageIndices, size_t levelStride);
+int runSweep(const char* sweepFile, const char* traceFile, size_t recordLimit, unsigned int threads);
+int runAddressSpaces(const char* traceFile, unsigned int levelCount, unsigned int* entryCount,
+                     const SimulatorConfig& config, size_t recordLimit, unsigned int threads);
+int runChunks(const char* traceFile, TraceFormat traceFormat, unsigned int levelCount, unsigned int* entryCount,
+              const SimulatorConfig& config, size_t recordLimit, unsigned int chunks, size_t warmup,
+              unsigned int threads, bool checkSerial);
+template <class RECORD>
+void simulateSerial(const RECORD* records, size_t recordCount, Simulator& simulator);
 
 int main (int argc, char *argv[]) {        
     //Variables for new command-line options
     int numAccesses = -1;
     int tlbSize = 0;
-    string outputMode = "summary"; //Default output mode
+    SimulatorConfig config = SimulatorConfig();
+    OutputMode outputMode = OUTPUT_SUMMARY; //Default output mode
+    bool showProgress = false;
+    bool useReaderThread = false;
+    bool collapseRuns = false;
+    unsigned int curveCapacity = 0; //Largest TLB capacity of the hit rate curve, 0 for none
+    size_t interval = 0; //Records between the rows of the time series, 0 for none
+    size_t samplePeriod = 0; //Records in each sampling period, 0 to simulate every record in detail
+    size_t sampleUnit = 0;
+    size_t sampleWarmup = 0;
+    unsigned int chunks = 0; //Chunks of the trace simulated in parallel, 0 to simulate it serially
+    size_t chunkWarmup = 0;
+    bool checkSerial = false;
+    bool tlbOptions = false; //Set once -c, -a, -r, -I, -D or -w configures the TLBs
+    bool pageOptions = false; //Set once -b, -H, -F or -e configures the page table
+    const char* sweepFile = nullptr;
+    const char* resultFile = nullptr; //Binary results of every translation, nullptr for none
+    unsigned int sweepThreads = thread::hardware_concurrency();
+    bool perProcess = false;
+    TraceFormat traceFormat = TRACE_BYU;
+    int addressBits = DEFAULT_ADDRESS_BITS_64; //Only used by byu64 traces, byu addresses are always BIT_SIZE wide
+    config.evictionPolicy = EVICT_CLOCK; //Default eviction policy, used once -F bounds physical memory
+    config.workingSetWindow = DEFAULT_WORKING_SET_WINDOW;
     
     unsigned int* entryCount = nullptr; //Entry count to be used for the level sizes
     unsigned int levelCount = 0; //Level count to denote how many levels the page table tree will have
 
     //Parse command-line options
     int option;
-    while ((option = getopt(argc, argv, "n:c:o:")) != -1) {
+    while ((option = getopt(argc, argv, "n:c:i:S:k:Eo:O:ptRa:I:D:r:m:s:j:Pb:f:v:w:H:F:e:")) != -1) {
         switch (option) {
             case 'n': //Limit the number of memory accesses
                 numAccesses = atoi(optarg); //Convert string argument to integer
@@ -37,14 +98,153 @@ int main (int argc, char *argv[]) {
                 }
                 break;
             case 'c': //TLB cache capacity
+                tlbOptions = true;
                 tlbSize = atoi(optarg); //Convert string argument to integer
                 if (tlbSize < 0) {
                     cerr << "Cache capacity must be a number, greater than or equal to 0.\n";
                     exit(NORMAL_EXIT);
                 }
                 break;
+            case 'I': //L1 instruction TLB capacity
+                tlbOptions = true;
+                config.itlbSize = atoi(optarg); //Convert string argument to integer
+                if (config.itlbSize < 0) {
+                    cerr << "Cache capacity must be a number, greater than or equal to 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'D': //L1 data TLB capacity
+                tlbOptions = true;
+                config.dtlbSize = atoi(optarg); //Convert string argument to integer
+                if (config.dtlbSize < 0) {
+                    cerr << "Cache capacity must be a number, greater than or equal to 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'a': //TLB associativity
+                tlbOptions = true;
+                config.tlbWays = atoi(optarg); //Convert string argument to integer
+                if (config.tlbWays <= 0) {
+                    cerr << "TLB ways must be a number, greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'r': //TLB replacement policy
+                tlbOptions = true;
+                if (!ReplacementPolicy::parse(optarg, config.tlbPolicy)) {
+                    cerr << "Replacement policy must be one of lru, clock, plru, random or arc.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'b': //Page table backend
+                pageOptions = true;
+                if (!PageTable::parse(optarg, config.pageTableBackend)) {
+                    cerr << "Page table backend must be one of levels, hashed or adaptive.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'f': //Trace record format
+                if (!TraceMap::parse(optarg, traceFormat)) {
+                    cerr << "Trace format must be one of byu or byu64.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'v': //Virtual address width of a byu64 trace
+                addressBits = atoi(optarg); //Convert string argument to integer
+                if (addressBits < BIT_SIZE || addressBits > MAX_BIT_SIZE) {
+                    cerr << "Virtual address bits must be a number, from 32 to 64.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'w': //Page walk cache entries for each upper level
+                tlbOptions = true;
+                if (!PageWalkCache::parse(optarg, config.walkCacheSizes)) {
+                    cerr << "Walk cache sizes must be numbers, greater than or equal to 0, separated by commas.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'H': //Huge pages at this depth, promoted once enough of their pages are mapped
+                pageOptions = true;
+                if (!parseHugePages(optarg, config)) {
+                    cerr << "Huge pages must be a level greater than 0, optionally followed by :<pages> greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'F': //Frames of physical memory
+                pageOptions = true;
+                if (atoi(optarg) <= 0) {
+                    cerr << "Number of frames must be a number, greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                config.frameLimit = atoi(optarg);
+                break;
+            case 'e': //Page eviction policy once physical memory is full
+                pageOptions = true;
+                if (!FrameTable::parse(optarg, config.evictionPolicy, config.workingSetWindow)) {
+                    cerr << "Eviction policy must be one of fifo, clock or wsclock[:window], with a window greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'm': //Hit rate curve for every TLB capacity up to N
+                if (atoi(optarg) <= 0) {
+                    cerr << "Largest cache capacity must be a number, greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                curveCapacity = atoi(optarg);
+                break;
+            case 'i': //Time series of the hits and page table, a row every N records
+                if (atoi(optarg) <= 0) {
+                    cerr << "Interval must be a number of records, greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                interval = atoi(optarg);
+                break;
+            case 'S': //Sample the trace instead of simulating every record in detail
+                if (!Sampler::parse(optarg, samplePeriod, sampleUnit, sampleWarmup)) {
+                    cerr << "Sampling must be <period>[:<unit>[:<warmup>]] records, with a unit greater than 0 and the unit and warmup fitting in the period. "
+                         << "A unit or warmup not given is a hundredth of the period, at least " << MIN_SAMPLE_UNIT << " records, as far as the period has room.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'k': //Simulate chunks of the trace in parallel
+                if (!TraceChunks::parse(optarg, chunks, chunkWarmup)) {
+                    cerr << "Chunks must be <chunks>[:<warmup>], from 1 to " << MAX_CHUNKS << " chunks and a number of warm-up records.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'E': //Measure the error of the chunks against a serial run
+                checkSerial = true;
+                break;
+            case 's': //Sweep over the configurations in a file
+                sweepFile = optarg;
+                break;
+            case 'P': //One address space per process
+                perProcess = true;
+                break;
+            case 'j': //Worker threads for a sweep or per process page tables
+                if (atoi(optarg) <= 0) {
+                    cerr << "Number of threads must be a number, greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                sweepThreads = atoi(optarg);
+                break;
             case 'o': //Output mode
-                outputMode = optarg;
+                if (!OutputWriter::parse(optarg, outputMode)) {
+                    cerr << "Output mode must be one of summary, bitmasks, va2pa, va2pa_atc_ptwalk, vpn2pfn or offset.\n";
+                    exit(NORMAL_EXIT);
+                }
+                break;
+            case 'O': //Write every translation to a binary result file
+                resultFile = optarg;
+                break;
+            case 'p': //Report progress on stderr
+                showProgress = true;
+                break;
+            case 't': //Read the trace on its own thread
+                useReaderThread = true;
+                break;
+            case 'R': //Count runs of records to the same page at once
+                collapseRuns = true;
                 break;
             default:
                 cerr << "Invalid argument\n";
@@ -52,23 +252,94 @@ int main (int argc, char *argv[]) {
         }
     }
 
+    //Result files hold the translations of a single simulator
+    if (resultFile != nullptr && (sweepFile != nullptr || perProcess || curveCapacity > 0)) {
+        cerr << "A result file can not be written with -s, -P or -m.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //A sweep takes every configuration from the sweep file and prints one row for each
+    if (sweepFile != nullptr && (outputMode != OUTPUT_SUMMARY || tlbOptions || pageOptions)) {
+        cerr << "A sweep takes its configurations from the sweep file, and can not be used with -o, -c, -a, -r, -I, -D, -w, -b, -H, -F or -e.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //The curve is of a fully associative LRU TLB at every capacity, and only needs the VPN of each access
+    if (curveCapacity > 0 && (outputMode != OUTPUT_SUMMARY || tlbOptions || pageOptions)) {
+        cerr << "The hit rate curve needs the summary output mode, and can not be used with -c, -a, -r, -I, -D, -w, -b, -H, -F or -e.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //Per process address spaces only give their counts, the page tables and TLBs are walked on different threads
+    if (perProcess && outputMode != OUTPUT_SUMMARY) {
+        cerr << "Per process address spaces need the summary output mode.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //Collapsed runs only leave the counts, so there is nothing to write per address
+    if (collapseRuns && (outputMode != OUTPUT_SUMMARY || resultFile != nullptr || sweepFile != nullptr ||
+                         perProcess || curveCapacity > 0)) {
+        cerr << "Run collapsing needs the summary output mode, and can not be used with -O, -s, -P or -m.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //The rows of the time series go out ahead of the summary, and come from a single simulator
+    if (interval > 0 && (outputMode != OUTPUT_SUMMARY || sweepFile != nullptr || perProcess || curveCapacity > 0)) {
+        cerr << "An interval needs the summary output mode, and can not be used with -s, -P or -m.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //A sampled run only estimates the counts, so there is nothing to write per address
+    if (samplePeriod > 0 && (outputMode != OUTPUT_SUMMARY || resultFile != nullptr || interval > 0 ||
+                             sweepFile != nullptr || perProcess || curveCapacity > 0)) {
+        cerr << "Sampling needs the summary output mode, and can not be used with -O, -i, -s, -P or -m.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //Chunks are merged into the summary, and every worker reads the same mapping of the trace
+    if (chunks > 0 && (outputMode != OUTPUT_SUMMARY || resultFile != nullptr || interval > 0 || samplePeriod > 0 ||
+                       collapseRuns || useReaderThread || sweepFile != nullptr || perProcess || curveCapacity > 0)) {
+        cerr << "Chunks need the summary output mode, and can not be used with -O, -i, -S, -R, -t, -s, -P or -m.\n";
+        exit(NORMAL_EXIT);
+    }
+    //Huge pages and evictions depend on every page mapped before a chunk, which its page table does not have
+    if (chunks > 0 && (config.hugePageDepth > 0 || config.frameLimit > 0)) {
+        cerr << "Chunks can not be used with -H or -F, as huge pages and evictions depend on the whole trace before each chunk.\n";
+        exit(NORMAL_EXIT);
+    }
+    if (checkSerial && chunks == 0) {
+        cerr << "The error against a serial run can only be measured with -k.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //Sweeps and per process address spaces only read 32 bit traces
+    if (traceFormat == TRACE_BYU64 && (sweepFile != nullptr || perProcess)) {
+        cerr << "The byu64 trace format can not be used with -s or -P.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //A sweep takes its configurations from the sweep file, so it only needs the trace file
+    if (sweepFile != nullptr) {
+        if (optind >= argc) {
+            cerr << "Usage: " << argv[0] << " -s <<sweepfile>> [options] <<tracefile>>.\n";
+            exit(NORMAL_EXIT);
+        }
+        size_t recordLimit = (numAccesses == -1) ? (size_t) -1 : (size_t) numAccesses;
+        return runSweep(sweepFile, argv[optind], recordLimit, sweepThreads);
+    }
+
     //Ensure that there are enough arguments for the trace file and level sizes
     if (optind >= argc || (argc - optind) < 2) {
         cerr << "Usage: " << argv[0] << " [options] <<tracefile>> <level sizes>.\n";
         exit(NORMAL_EXIT);
     }
 
-    //Open the trace file
-    FILE *tracef_h = fopen(argv[optind], "r");
-    if (!tracef_h) {
-        cerr << "Unable to open <<" << argv[optind] << ">>\n";
-        exit(NORMAL_EXIT);
-    }
+    config.tlbSize = tlbSize;
 
     //Parse the page table level sizes starting from the next argument
     entryCount = parseCommandLineArguments(argc, argv, optind + 1, levelCount);
     
-    //Check if total bits used in page table levels exceed 28
+    //Check if total bits used in page table levels exceed 28, or for a byu64 trace leave no room for the offset
     int totalBits = 0;
     for (int i = 0; i < levelCount; i++) {
         totalBits += atoi(argv[optind + 1 + i]);
@@ -77,128 +348,425 @@ int main (int argc, char *argv[]) {
             cerr << "Level " << i << " page table must be at least 1 bit\n";
             exit(NORMAL_EXIT);
         }
+        if(atoi(argv[optind + 1 + i]) > MAX_FIELD_BITS) {
+            cerr << "Level " << i << " page table must be at most " << MAX_FIELD_BITS << " bits\n";
+            exit(NORMAL_EXIT);
+        }
     }
-    if (totalBits > 28) {
-        cerr << "Too many bits used in page tables\n";
-        exit(NORMAL_EXIT);
+    if (traceFormat == TRACE_BYU) {
+        config.addressBits = BIT_SIZE;
+        if (totalBits > 28) {
+            cerr << "Too many bits used in page tables\n";
+            exit(NORMAL_EXIT);
+        }
+    } else {
+        //The TLB keeps the ASID and the huge page bit above TLB_VPN_BITS in its tags, so a VPN has to fit below them
+        config.addressBits = addressBits;
+        if (totalBits >= addressBits || totalBits > TLB_VPN_BITS) {
+            cerr << "Too many bits used in page tables\n";
+            exit(NORMAL_EXIT);
+        }
+        if (addressBits - totalBits > MAX_OFFSET_BITS) {
+            cerr << "Too few bits used in page tables, the page offset can be at most " << MAX_OFFSET_BITS << " bits\n";
+            exit(NORMAL_EXIT);
+        }
     }
 
+    //The walk cache, huge pages, frame limit and TLBs have to fit the levels and each other, as on a sweep line
+    string configError;
+    if (!isValidConfig(config, levelCount, entryCount, perProcess, configError)) {
+        cerr << configError << ".\n";
+        exit(NORMAL_EXIT);
+    }
 
-    //Create a new page table with the corresponding levels and entry counts
-    PageTable pageTable = PageTable(levelCount, entryCount);
+    //Per process address spaces shard the mapped trace across workers, so they take their own path
+    if (perProcess) {
+        size_t recordLimit = (numAccesses == -1) ? (size_t) -1 : (size_t) numAccesses;
+        int status = runAddressSpaces(argv[optind], levelCount, entryCount, config, recordLimit, sweepThreads);
+        delete[] entryCount;
+        return status;
+    }
 
-    //Helper variables used to handle the outputs
-    unsigned int* bitMaskAry = pageTable.getBitMaskAry();  
-    unsigned int* shiftAry = pageTable.getShiftAry();  
-    unsigned int* pageIndices = new unsigned int[levelCount];  
+    //Chunks of the trace are simulated on worker threads and merged
+    if (chunks > 0) {
+        size_t recordLimit = (numAccesses == -1) ? (size_t) -1 : (size_t) numAccesses;
+        int status = runChunks(argv[optind], traceFormat, levelCount, entryCount, config, recordLimit, chunks,
+                               chunkWarmup, sweepThreads, checkSerial);
+        delete[] entryCount;
+        return status;
+    }
 
-    //Create the TLB if cache size is specified
-    TLB* tlb = nullptr;
-    if (tlbSize > 0) {
-        tlb = new TLB(tlbSize);
+    //Open the trace file, mapping it unless the reader thread was asked for
+    TraceSource traceSource;
+    if (!traceSource.open(argv[optind], useReaderThread, traceFormat)) {
+        cerr << "Unable to open <<" << argv[optind] << ">>\n";
+        exit(NORMAL_EXIT);
     }
 
+    //Create a new simulator with the corresponding levels, entry counts and TLB size
+    Simulator simulator(levelCount, entryCount, config);
+    PageTable* pageTable = simulator.getPageTable();
+
+    //Helper variables used to handle the outputs
+    uint64_t* bitMaskAry = pageTable->getBitMaskAry();  
+    unsigned int* shiftAry = pageTable->getShiftAry();  
+
     //Handle output for bitmasks mode
-    if (outputMode == "bitmasks") {
+    if (outputMode == OUTPUT_BITMASKS) {
         log_bitmasks(levelCount, bitMaskAry);
-        fclose(tracef_h);
         return 0; //End execution if we only need to print bitmasks
     }
 
-    //Process the trace file
-    p2AddrTr mtrace;
-    unsigned int vAddr;
-    int accessCount = 0;
-    int tlbHits = 0;
-    int pageTableHits = 0;
+    //Process the trace file, limited to the first N records by -n N
+    size_t recordLimit = (numAccesses == -1) ? (size_t) -1 : (size_t) numAccesses;
+    size_t recordTotal = traceSource.getRecordCount();
+    if (recordTotal > recordLimit) {
+        recordTotal = recordLimit;
+    }
+
+    //The hit rate curve only needs the VPN of each access
+    StackDistance* stackDistance = nullptr;
+    if (curveCapacity > 0) {
+        stackDistance = new StackDistance(curveCapacity);
+    }
+
+    //Only the sample units and the records just before them are simulated in detail
+    Sampler* sampler = nullptr;
+    if (samplePeriod > 0) {
+        sampler = new Sampler(samplePeriod, sampleUnit, sampleWarmup);
+    }
+
+    //The result file starts with the configuration, the records follow as they are translated
+    ResultWriter* results = nullptr;
+    if (resultFile != nullptr) {
+        results = new ResultWriter();
+        if (!results->open(resultFile, levelCount, entryCount, config)) {
+            cerr << "Unable to write <<" << resultFile << ">>\n";
+            exit(NORMAL_EXIT);
+        }
+    }
 
-    while (NextAddress(tracef_h, &mtrace)) {
-        vAddr = mtrace.addr;
+    //The records differ only in the width of their address, so one loop serves both formats
+    size_t recordCount;
+    if (traceFormat == TRACE_BYU64) {
+        recordCount = simulateTrace<p2AddrTr64>(traceSource, simulator, stackDistance, sampler, outputMode, results,
+                                                collapseRuns, levelCount, recordLimit, recordTotal, interval, showProgress);
+    } else {
+        recordCount = simulateTrace<p2AddrTr>(traceSource, simulator, stackDistance, sampler, outputMode, results,
+                                              collapseRuns, levelCount, recordLimit, recordTotal, interval, showProgress);
+    }
 
-        //Stop processing if the number of accesses is limited by -n N
-        if (numAccesses != -1 && accessCount >= numAccesses) {
-            break;
+    if (results != nullptr) {
+        if (!results->close()) {
+            cerr << "Unable to write <<" << resultFile << ">>\n";
+            exit(NORMAL_EXIT);
         }
+        delete results;
+    }
+
+    //Handle hit rate curve mode
+    if (stackDistance != nullptr) {
+        vector<unsigned long> hits(curveCapacity + 1, 0);
+        stackDistance->getHitCurve(hits.data());
+        log_hitratecurve(curveCapacity, hits.data(), stackDistance->getAccessCount());
+
+        delete stackDistance;
+        delete[] entryCount;
+        return 0;
+    }
+
+    if (showProgress) {
+        fprintf(stderr, "\n");
+    }
+
+    //A sampled run estimates the rates of the whole trace from its units
+    if (sampler != nullptr) {
+        SampleEstimate tlbHitRate = sampler->getEstimate(recordCount);
+        unsigned long pageFaults = simulator.getAccessCount() - simulator.getTlbHits() - simulator.getPageTableHits() +
+                                   simulator.getWarmFaults();
+        log_sampled(1 << shiftAry[levelCount - 1], recordCount, simulator.getAccessCount(), sampler->getUnits(),
+                    sampler->getUnitSize(), tlbHitRate.mean, tlbHitRate.halfWidth, pageFaults,
+                    pageTable->getFramesAllocated(), pageTable->getTotalPageTableEntries());
+
+        delete sampler;
+        traceSource.close();
+        delete[] entryCount;
+        return 0;
+    }
 
-        //Find the page indices based on the address and the masks
-        for (int i = 0; i < levelCount; i++) {
-            pageIndices[i] = pageTable.extractPageNumberFromAddress(vAddr, bitMaskAry[i], shiftAry[i]);
+    //Handle summary output mode
+    if (outputMode == OUTPUT_SUMMARY) {
+        unsigned int pageSize = 1 << shiftAry[levelCount - 1]; //Compute page size
+        unsigned int framesUsed = pageTable->getFramesAllocated(); //Placeholder for frames used
+        unsigned long int totalPageTableEntries = pageTable->getTotalPageTableEntries(); //Placeholder for page table entries
+
+        log_summary(pageSize, simulator.getTlbHits(), simulator.getPageTableHits(),
+                    simulator.getAccessCount(), framesUsed, totalPageTableEntries);
+
+        //Break the TLB hits down by level when there is a hierarchy
+        if (simulator.hasL1Tlbs()) {
+            TLBLevelStats itlb = simulator.getItlbStats();
+            TLBLevelStats dtlb = simulator.getDtlbStats();
+            TLBLevelStats l2 = simulator.getTlbStats();
+            log_tlblevels(itlb.lookups, itlb.hits, dtlb.lookups, dtlb.hits, l2.lookups, l2.hits);
         }
 
-        // Combine page indices across all levels to get the full VPN
-        unsigned int vpn = 0;
-        unsigned int shiftAmt = 0;
-        for (int i = 0; i < levelCount; i++) {
-            vpn = vpn << BIT_SIZE - shiftAry[i] - shiftAmt;
-            vpn = vpn | pageIndices[i];
-            shiftAmt = BIT_SIZE - shiftAry[i];
+        //Split the translations by page size
+        if (config.hugePageDepth > 0) {
+            LevelPageTable* levelPageTable = (LevelPageTable*) pageTable;
+            unsigned long hugePageSize = (unsigned long) pageSize * levelPageTable->getHugePageFrames();
+            log_pagesizes(pageSize, simulator.getAccessCount() - simulator.getHugePageAccesses(),
+                          simulator.getTlbHits() - simulator.getHugePageTlbHits(), hugePageSize,
+                          simulator.getHugePageAccesses(), simulator.getHugePageTlbHits(),
+                          levelPageTable->getHugePagesMapped());
         }
 
-        //Check the TLB first
-        int pfn = -1;
-        bool tlbHit = false;
-        bool pageTableHit = false;
+        //Show how often bounded memory had to fault pages in and evict others
+        FrameTable* frameTable = simulator.getFrameTable();
+        if (frameTable != nullptr) {
+            unsigned long pageFaults = simulator.getAccessCount() - simulator.getTlbHits() - simulator.getPageTableHits();
+            log_frames(frameTable->getFrameCount(), pageFaults, frameTable->getEvictions(), simulator.getAccessCount());
+        }
 
-        if (tlb != nullptr) {
-            pfn = tlb->lookup(vpn);
-            if (pfn != -1) {
-                tlbHit = true;
-                tlbHits++;
+        //Show how far the walks that missed every TLB got to skip
+        PageWalkCache* walkCache = simulator.getWalkCache();
+        if (walkCache != nullptr) {
+            unsigned int cacheLevels = walkCache->getCacheLevels();
+            vector<unsigned int> entries(cacheLevels);
+            vector<unsigned long> hits(cacheLevels);
+            for (unsigned int i = 0; i < cacheLevels; i++) {
+                entries[i] = walkCache->getSize(i);
+                hits[i] = walkCache->getHits(i);
             }
+            log_walkcache(cacheLevels, entries.data(), hits.data(), walkCache->getWalks(),
+                          walkCache->getStepsSaved(), walkCache->getSteps());
         }
+    }
+
+    //Close the trace file
+    traceSource.close();
+
+    //Free dynamic memory, the page table frees its own
+    delete[] entryCount;
+    
+    return 0;
+}
+
+//Method to run the records of the trace, up to recordLimit of them, through the simulator or the hit rate curve.
+//Returns the number of records run
+template <class RECORD>
+size_t simulateTrace(TraceSource& traceSource, Simulator& simulator, StackDistance* stackDistance, Sampler* sampler,
+                     OutputMode outputMode, ResultWriter* results, bool collapseRuns, unsigned int levelCount,
+                     size_t recordLimit, size_t recordTotal, size_t interval, bool showProgress) {
+    PageTable* pageTable = simulator.getPageTable();
+    OutputWriter output(stdout);
+
+    //Every batch is split at once, the hit rate curve only needs its VPNs
+    vector<uint64_t> vpns;
+    vector<uint64_t> offsets;
+    vector<unsigned int> pageIndices;
+
+    //Records left in the current interval and the counts at the end of the last one, without -i there is no end
+    size_t nextInterval = (interval > 0) ? interval : (size_t) -1;
+    unsigned long intervalCounts[3] = { 0, 0, 0 };
 
-        //If not found in TLB, check the page table
-        if (pfn == -1) {
-            pfn = pageTable.recordPageAccess(vAddr, pageTable.getRoot(), pageTableHit);
-            if (pageTableHit == true) {
-                pageTableHits++;
+    const RECORD* batch;
+    size_t batchCount;
+    size_t record = 0;
+    while (record < recordLimit && (batchCount = traceSource.nextBatch(&batch)) > 0) {
+        if (batchCount > recordLimit - record) {
+            batchCount = recordLimit - record;
+        }
+
+        if (vpns.size() < batchCount) {
+            vpns.resize(batchCount);
+            offsets.resize(batchCount);
+            pageIndices.resize((size_t) levelCount * batchCount);
+        }
+        if (stackDistance != nullptr) {
+            pageTable->decomposeBatch(batch, batchCount, vpns.data(), nullptr, nullptr);
+        } else {
+            pageTable->decomposeBatch(batch, batchCount, vpns.data(), offsets.data(), pageIndices.data());
+        }
+
+        //A batch is cut at the end of every interval, so each row counts exactly the records of its interval
+        for (size_t start = 0; start < batchCount;) {
+            size_t count = batchCount - start;
+            if (count > nextInterval - (record + start)) {
+                count = nextInterval - (record + start);
             }
-            if (tlb != nullptr) {
-                tlb->insert(vpn, pfn);  //Insert into TLB
+            const RECORD* records = batch + start;
+
+            //The split of these records, each level of their page indices batchCount apart
+            const uint64_t* recordVpns = vpns.data() + start;
+            const uint64_t* recordOffsets = offsets.data() + start;
+            const unsigned int* recordIndices = pageIndices.data() + start;
+
+            //A sampled run is also cut where its phase changes
+            SamplePhase phase = SAMPLE_MEASURE;
+            if (sampler != nullptr) {
+                size_t phaseEnd;
+                phase = sampler->next(record + start, phaseEnd, simulator);
+                if (count > phaseEnd - (record + start)) {
+                    count = phaseEnd - (record + start);
+                }
+            }
+
+            //The mode is picked once per batch, so each loop below is specialized on its line format
+            if (phase == SAMPLE_FUNCTIONAL) {
+                for (size_t i = 0; i < count; i++) {
+                    simulator.warm(records[i].addr, recordVpns[i], records[i].reqtype, records[i].time);
+                }
+            } else if (stackDistance != nullptr) {
+                for (size_t i = 0; i < count; i++) {
+                    stackDistance->access(recordVpns[i]);
+                }
+            } else if (collapseRuns) {
+                collapseBatch(simulator, records, count, recordVpns, recordOffsets, recordIndices, batchCount);
+            } else {
+                switch (outputMode) {
+                    case OUTPUT_VA2PA:
+                        translateBatch<OUTPUT_VA2PA>(simulator, output, results, records, count, levelCount,
+                                                     recordVpns, recordOffsets, recordIndices, batchCount);
+                        break;
+                    case OUTPUT_VA2PA_ATC_PTWALK:
+                        translateBatch<OUTPUT_VA2PA_ATC_PTWALK>(simulator, output, results, records, count, levelCount,
+                                                                recordVpns, recordOffsets, recordIndices, batchCount);
+                        break;
+                    case OUTPUT_VPN2PFN:
+                        translateBatch<OUTPUT_VPN2PFN>(simulator, output, results, records, count, levelCount,
+                                                       recordVpns, recordOffsets, recordIndices, batchCount);
+                        break;
+                    case OUTPUT_OFFSET:
+                        translateBatch<OUTPUT_OFFSET>(simulator, output, results, records, count, levelCount,
+                                                      recordVpns, recordOffsets, recordIndices, batchCount);
+                        break;
+                    default:
+                        translateBatch<OUTPUT_SUMMARY>(simulator, output, results, records, count, levelCount,
+                                                       recordVpns, recordOffsets, recordIndices, batchCount);
+                        break;
+                }
+            }
+            start += count;
+
+            if (record + start == nextInterval) {
+                reportInterval(simulator, intervalCounts, nextInterval == interval);
+                nextInterval += interval;
             }
         }
+        traceSource.releaseBatch();
+        record += batchCount;
 
-        //Output results for va2pa_atc_ptwalk mode
-        if (outputMode == "va2pa_atc_ptwalk") {
-            unsigned int offset = vAddr & ((1 << shiftAry[levelCount - 1]) - 1);
-            unsigned int physicalAddr = (pfn << shiftAry[levelCount - 1]) | offset;
-            log_va2pa_ATC_PTwalk(vAddr, physicalAddr, tlbHit, pageTableHit);
-        } else if (outputMode == "offset") {
-            //Output the offset part of the virtual address
-            unsigned int offset = vAddr & ((1 << shiftAry[levelCount - 1]) - 1);
-            hexnum(offset);
-        } else if (outputMode == "vpn2pfn") {
-            //Output VPN to PFN mapping
-            log_pagemapping(levelCount, pageIndices, pfn);
-        } else if (outputMode == "va2pa") {
-            //Output VA to PA mapping without TLB and page table lookup details
-            unsigned int offset = vAddr & ((1 << shiftAry[levelCount - 1]) - 1);
-            unsigned int physicalAddr = (pfn << shiftAry[levelCount - 1]) | offset;
-            log_virtualAddr2physicalAddr(vAddr, physicalAddr);
+        if (showProgress && (record & (PROGRESS_INTERVAL - 1)) < batchCount) {
+            reportProgress(record, recordTotal);
         }
+    }
 
-        accessCount++;
+    if (sampler != nullptr) {
+        sampler->finish(record, simulator);
     }
 
-    //Handle summary output mode
-    if (outputMode == "summary") {
-        unsigned int pageSize = 1 << shiftAry[levelCount - 1]; //Compute page size
-        unsigned int framesUsed = pageTable.getFramesAllocated(); //Placeholder for frames used
-        unsigned long int totalPageTableEntries = pageTable.getTotalPageTableEntries(); //Placeholder for page table entries
+    //The last interval may be cut short by the end of the trace
+    if (interval > 0 && simulator.getAccessCount() > intervalCounts[0]) {
+        reportInterval(simulator, intervalCounts, nextInterval == interval);
+    }
+
+    //Everything after the trace goes through printf, so the lines have to be out first
+    output.flush();
+    return record;
+}
+
+//Method to write the row of the interval that just ended, last holds the accesses, TLB hits and
+//page table hits at the end of the one before it and is moved up to these
+void reportInterval(Simulator& simulator, unsigned long* last, bool header) {
+    PageTable* pageTable = simulator.getPageTable();
+    unsigned long accesses = simulator.getAccessCount();
+    unsigned long tlbHits = simulator.getTlbHits();
+    unsigned long pageTableHits = simulator.getPageTableHits();
+
+    log_interval(header, accesses, accesses - last[0], tlbHits - last[1], pageTableHits - last[2],
+                 pageTable->getFramesAllocated(), pageTable->getLevelsAllocated(),
+                 pageTable->getTotalPageTableEntries());
+
+    last[0] = accesses;
+    last[1] = tlbHits;
+    last[2] = pageTableHits;
+}
+
+//Method to translate one batch of records, writing the line of each for a per address output mode.
+//The records are already split, the page index of record i on level l at pageIndices[l * levelStride + i]
+template <OutputMode MODE, class RECORD>
+void translateBatch(Simulator& simulator, OutputWriter& output, ResultWriter* results, const RECORD* batch,
+                    size_t batchCount, unsigned int levelCount, const uint64_t* vpns, const uint64_t* offsets,
+                    const unsigned int* pageIndices, size_t levelStride) {
+    Translation translation;
+    for (size_t i = 0; i < batchCount; i++) {
+        simulator.translate(batch[i].addr, vpns[i], offsets[i], pageIndices + i, levelStride, batch[i].reqtype,
+                            batch[i].time, translation);
+
+        //MODE is a constant, so only the line of this mode is left in the loop
+        if (MODE == OUTPUT_VA2PA_ATC_PTWALK) {
+            output.writeVa2paAtcPtwalk(translation.vAddr, translation.pAddr, translation.tlbHit, translation.pageTableHit);
+        } else if (MODE == OUTPUT_OFFSET) {
+            output.writeOffset(translation.offset);
+        } else if (MODE == OUTPUT_VPN2PFN) {
+            //A TLB hit does not copy the page indices, so they are taken from the batch
+            if (translation.tlbHit) {
+                for (unsigned int level = 0; level < levelCount; level++) {
+                    translation.pageIndices[level] = pageIndices[level * levelStride + i];
+                }
+            }
+            output.writeVpn2pfn(levelCount, translation.pageIndices, translation.pfn);
+        } else if (MODE == OUTPUT_VA2PA) {
+            output.writeVa2pa(translation.vAddr, translation.pAddr);
+        }
 
-        log_summary(pageSize, tlbHits, pageTableHits, accessCount, framesUsed, totalPageTableEntries);
+        if (results != nullptr) {
+            results->write(translation, batch[i].reqtype, batch[i].proc, batch[i].time);
+        }
     }
+}
 
-    //Close the trace file
-    fclose(tracef_h);
+//Method to translate one batch of records a run at a time, a run being the records to one page from one side.
+//Once a record of the run hits the first TLB it probes, the rest of the run are counted as hits without translating
+template <class RECORD>
+void collapseBatch(Simulator& simulator, const RECORD* batch, size_t batchCount, const uint64_t* vpns,
+                   const uint64_t* offsets, const unsigned int* pageIndices, size_t levelStride) {
+    Translation translation;
+    size_t record = 0;
+    while (record < batchCount) {
+        simulator.translate(batch[record].addr, vpns[record], offsets[record], pageIndices + record, levelStride,
+                            batch[record].reqtype, batch[record].time, translation);
 
-    //Free dynamic memory
-    delete[] bitMaskAry;
-    delete[] shiftAry;
-    delete[] pageIndices;
-    delete tlb;
-    
-    return 0;
+        //Find the end of the run and the time it spans
+        bool fetch = (batch[record].reqtype == FETCH);
+        size_t end = record + 1;
+        uint64_t elapsed = 0;
+        while (end < batchCount && vpns[end] == translation.vpn &&
+               (batch[end].reqtype == FETCH) == fetch) {
+            elapsed += batch[end].time;
+            end++;
+        }
+
+        //Records before the first TLB hit, or all of them without a TLB, are translated one at a time
+        for (record++; record < end && !simulator.canRepeat(translation.vpn, batch[record].reqtype); record++) {
+            simulator.translate(batch[record].addr, vpns[record], offsets[record], pageIndices + record, levelStride,
+                                batch[record].reqtype, batch[record].time, translation);
+            elapsed -= batch[record].time;
+        }
+        if (record < end) {
+            simulator.repeat(batch[record].reqtype, end - record, elapsed);
+            record = end;
+        }
+    }
+}
+
+//Method to report how many records have been processed, total is 0 when it is unknown
+void reportProgress(size_t processed, size_t total) {
+    if (total > 0)
+        fprintf(stderr, "%zuK of %zuK records processed\r", processed >> 10, total >> 10);
+    else
+        fprintf(stderr, "%zuK records processed\r", processed >> 10);
 }
 
 //Method to parse the page table level sizes from multiple arguments
@@ -212,3 +780,154 @@ unsigned int* parseCommandLineArguments(int argc, char *argv[], int optind, unsi
 
     return entryCount;
 }
+
+//Method to simulate every configuration of a sweep file over one mapped trace and print a row for each
+int runSweep(const char* sweepFile, const char* traceFile, size_t recordLimit, unsigned int threads) {
+    Sweep sweep;
+    string error;
+    if (!sweep.load(sweepFile, error)) {
+        cerr << error << ".\n";
+        exit(NORMAL_EXIT);
+    }
+
+    //Every worker reads the same mapping, so the trace has to be mappable
+    TraceMap traceMap;
+    if (!traceMap.open(traceFile, TRACE_BYU, true)) {
+        cerr << "Unable to map <<" << traceFile << ">>\n";
+        exit(NORMAL_EXIT);
+    }
+
+    size_t recordCount = traceMap.getRecordCount();
+    if (recordCount > recordLimit) {
+        recordCount = recordLimit;
+    }
+    sweep.run(&traceMap, recordCount, threads);
+
+    vector<SweepConfig>& configs = sweep.getConfigs();
+    vector<SweepResult>& results = sweep.getResults();
+    for (size_t i = 0; i < configs.size(); i++) {
+        SweepResult& result = results[i];
+        log_sweeprow(i == 0, configs[i].label.c_str(), result.pageSize, result.tlbHits, result.pageTableHits,
+                     result.accesses, result.framesAllocated, result.pageTableEntries,
+                     result.pageTableBytes, result.seconds);
+    }
+
+    traceMap.close();
+    return 0;
+}
+
+//Method to simulate one address space per process over a mapped trace and print each process, then the system
+int runAddressSpaces(const char* traceFile, unsigned int levelCount, unsigned int* entryCount,
+                     const SimulatorConfig& config, size_t recordLimit, unsigned int threads) {
+    //Every worker reads the same mapping, so the trace has to be mappable
+    TraceMap traceMap;
+    if (!traceMap.open(traceFile, TRACE_BYU, true)) {
+        cerr << "Unable to map <<" << traceFile << ">>\n";
+        exit(NORMAL_EXIT);
+    }
+
+    size_t recordCount = traceMap.getRecordCount();
+    if (recordCount > recordLimit) {
+        recordCount = recordLimit;
+    }
+
+    AddressSpaces addressSpaces(levelCount, entryCount, config);
+    addressSpaces.run(&traceMap, recordCount, threads);
+
+    for (unsigned int proc = 0; proc < MAX_ADDRESS_SPACES; proc++) {
+        if (addressSpaces.isUsed(proc)) {
+            AddressSpaceResult result = addressSpaces.getResult(proc);
+            log_processsummary(proc, result.tlbHits, result.pageTableHits, result.accesses,
+                               result.framesAllocated, result.pageTableEntries);
+        }
+    }
+
+    AddressSpaceResult total = addressSpaces.getTotal();
+    log_summary(addressSpaces.getPageSize(), total.tlbHits, total.pageTableHits,
+                total.accesses, total.framesAllocated, total.pageTableEntries);
+
+    //Break the TLB hits down by level when there is a hierarchy
+    TLBHierarchy* tlbs = addressSpaces.getTlbs();
+    if (tlbs->hasL1Tlbs()) {
+        TLBLevelStats itlb = tlbs->getItlbStats();
+        TLBLevelStats dtlb = tlbs->getDtlbStats();
+        TLBLevelStats l2 = tlbs->getTlbStats();
+        log_tlblevels(itlb.lookups, itlb.hits, dtlb.lookups, dtlb.hits, l2.lookups, l2.hits);
+    }
+
+    traceMap.close();
+    return 0;
+}
+
+//Method to simulate chunks of a mapped trace in parallel and print each chunk, then the merged summary,
+//and with checkSerial how far it is from a serial run
+int runChunks(const char* traceFile, TraceFormat traceFormat, unsigned int levelCount, unsigned int* entryCount,
+              const SimulatorConfig& config, size_t recordLimit, unsigned int chunks, size_t warmup,
+              unsigned int threads, bool checkSerial) {
+    //Every worker reads the same mapping, so the trace has to be mappable
+    TraceMap traceMap;
+    if (!traceMap.open(traceFile, traceFormat, true)) {
+        cerr << "Unable to map <<" << traceFile << ">>\n";
+        exit(NORMAL_EXIT);
+    }
+
+    size_t recordCount = traceMap.getRecordCount();
+    if (recordCount > recordLimit) {
+        recordCount = recordLimit;
+    }
+
+    TraceChunks traceChunks(levelCount, entryCount, config, chunks, warmup);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    traceChunks.run(&traceMap, recordCount, threads);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    for (unsigned int chunk = 0; chunk < traceChunks.getChunkCount(); chunk++) {
+        ChunkResult result = traceChunks.getResult(chunk);
+        log_chunksummary(chunk, result.firstRecord, result.records, result.warmupRecords, result.tlbHits);
+    }
+
+    //The misses and frames are exact, the page hits are every access left
+    ChunkResult total = traceChunks.getTotal();
+    Simulator* pageTableSimulator = traceChunks.getPageTableSimulator();
+    PageTable* pageTable = pageTableSimulator->getPageTable();
+    unsigned long misses = pageTableSimulator->getWarmFaults();
+    unsigned long pageTableHits = total.records - total.tlbHits - misses;
+    unsigned int pageSize = 1 << pageTable->getShiftAry()[levelCount - 1];
+    log_summary(pageSize, total.tlbHits, pageTableHits, total.records, pageTable->getFramesAllocated(),
+                pageTable->getTotalPageTableEntries());
+
+    //Break the TLB hits down by level when there is a hierarchy
+    if (config.itlbSize > 0 || config.dtlbSize > 0) {
+        log_tlblevels(total.itlb.lookups, total.itlb.hits, total.dtlb.lookups, total.dtlb.hits,
+                      total.tlb.lookups, total.tlb.hits);
+    }
+
+    //Run the whole trace on one simulator for the counts the chunks should have given
+    if (checkSerial) {
+        Simulator simulator(levelCount, entryCount, config);
+        start = chrono::steady_clock::now();
+        if (traceFormat == TRACE_BYU64) {
+            simulateSerial(traceMap.getRecords64(), recordCount, simulator);
+        } else {
+            simulateSerial(traceMap.getRecords(), recordCount, simulator);
+        }
+        chrono::duration<double> serialElapsed = chrono::steady_clock::now() - start;
+
+        unsigned long serialMisses = simulator.getAccessCount() - simulator.getTlbHits() - simulator.getPageTableHits();
+        log_chunkerror(total.records, total.tlbHits, simulator.getTlbHits(), pageTableHits,
+                       simulator.getPageTableHits(), misses, serialMisses, elapsed.count(),
+                       traceChunks.getMergeSeconds(), serialElapsed.count());
+    }
+
+    traceMap.close();
+    return 0;
+}
+
+//Method to translate the first recordCount records of a mapped trace in order on one simulator
+template <class RECORD>
+void simulateSerial(const RECORD* records, size_t recordCount, Simulator& simulator) {
+    Translation translation;
+    for (size_t record = 0; record < recordCount; record++) {
+        simulator.translate(records[record].addr, records[record].reqtype, records[record].time, translation);
+    }
+}
@@ -0,0 +1,51 @@
+//This is the work of Teddy Barker
+
+#include "outputWriter.h"
+
+#include <cstring>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+OutputWriter::OutputWriter(FILE* stream) {
+    this->stream = stream;
+    buffer = new char[OUTPUT_BUFFER_SIZE];
+    cursor = buffer;
+    limit = buffer + OUTPUT_BUFFER_SIZE - OUTPUT_LINE_MAX;
+}
+
+OutputWriter::~OutputWriter() {
+    flush();
+    delete[] buffer;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Hands every line written so far to the stream and empties the buffer
+ */
+void OutputWriter::flush() {
+    if (cursor != buffer) {
+        fwrite(buffer, 1, cursor - buffer, stream);
+        cursor = buffer;
+    }
+    fflush(stream);
+}
+
+/**
+ * Looks up an output mode by its command line name, summary, bitmasks, va2pa,
+ * va2pa_atc_ptwalk, vpn2pfn or offset. Returns false if there is no mode by that name
+ */
+bool OutputWriter::parse(const char* name, OutputMode& mode) {
+    static const char* names[] = { "summary", "bitmasks", "va2pa", "va2pa_atc_ptwalk", "vpn2pfn", "offset" };
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(name, names[i]) == 0) {
+            mode = (OutputMode) i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,152 @@
+//This is the work of Teddy Barker
+
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//Bytes gathered before the writer hands them to stdout
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+//Room kept free for one line, the widest is a vpn2pfn line of 64 levels
+#define OUTPUT_LINE_MAX 1024
+
+/**
+ * Output modes, picked once with -o:
+ *  - the summary after the whole trace, the default
+ *  - the bitmask of every level, without reading the trace
+ *  - one line per address in each of the other modes
+ */
+enum OutputMode {
+    OUTPUT_SUMMARY,
+    OUTPUT_BITMASKS,
+    OUTPUT_VA2PA,
+    OUTPUT_VA2PA_ATC_PTWALK,
+    OUTPUT_VPN2PFN,
+    OUTPUT_OFFSET
+};
+
+/*
+ * Output Writer class
+ *   The sink of the per address output modes. Lines are formatted by
+ *   hand straight into one large buffer, which goes to stdout in a
+ *   single write whenever it fills, instead of a printf and a flush for
+ *   every address. The lines are the same as the ones log.cpp writes,
+ *   hex numbers in upper case with addresses padded to 8 digits.
+ *   Flush before anything else writes to stdout.
+*/
+class OutputWriter {
+    public:
+        OutputWriter(FILE* stream);
+        ~OutputWriter();
+
+        //The writer owns its buffer, so it can not be copied
+        OutputWriter(const OutputWriter&) = delete;
+        OutputWriter& operator=(const OutputWriter&) = delete;
+
+        void writeVa2pa(uint64_t vAddr, uint64_t pAddr);
+        void writeVa2paAtcPtwalk(uint64_t vAddr, uint64_t pAddr, bool tlbHit, bool pageTableHit);
+        void writeVpn2pfn(unsigned int levels, const unsigned int* pages, unsigned int frame);
+        void writeOffset(uint64_t offset);
+        void flush();
+
+        static bool parse(const char* name, OutputMode& mode);
+
+    private:
+        FILE* stream;
+        char* buffer;
+        char* cursor; //Where the next line starts
+        char* limit; //A line that starts past this might not fit
+
+        void reserveLine();
+        void writeHex(uint64_t value, unsigned int minDigits);
+        void writeText(const char* text, size_t length);
+};
+
+/**
+ * Makes sure the next line fits, handing the buffer to the stream once it is nearly full
+ */
+inline void OutputWriter::reserveLine() {
+    if (cursor > limit)
+        flush();
+}
+
+/**
+ * Writes value in upper case hex, padded with zeros to at least minDigits digits
+ */
+inline void OutputWriter::writeHex(uint64_t value, unsigned int minDigits) {
+    static const char digits[] = "0123456789ABCDEF";
+
+    //Four bits to a digit, counting the highest set bit
+    unsigned int count = (64 - __builtin_clzll(value | 1) + 3) >> 2;
+    if (count < minDigits)
+        count = minDigits;
+
+    for (char* digit = cursor + count; digit-- != cursor; value >>= 4)
+        *digit = digits[value & 0xF];
+    cursor += count;
+}
+
+/**
+ * Copies text of this length into the buffer
+ */
+inline void OutputWriter::writeText(const char* text, size_t length) {
+    for (size_t i = 0; i < length; i++)
+        cursor[i] = text[i];
+    cursor += length;
+}
+
+/**
+ * Writes the line of va2pa mode, vAddr -> pAddr
+ */
+inline void OutputWriter::writeVa2pa(uint64_t vAddr, uint64_t pAddr) {
+    reserveLine();
+    writeHex(vAddr, 8);
+    writeText(" -> ", 4);
+    writeHex(pAddr, 8);
+    *cursor++ = '\n';
+}
+
+/**
+ * Writes the line of va2pa_atc_ptwalk mode, the va2pa line followed by
+ * the TLB hit or miss and on a miss the page table hit or miss
+ */
+inline void OutputWriter::writeVa2paAtcPtwalk(uint64_t vAddr, uint64_t pAddr, bool tlbHit, bool pageTableHit) {
+    reserveLine();
+    writeHex(vAddr, 8);
+    writeText(" -> ", 4);
+    writeHex(pAddr, 8);
+    if (tlbHit)
+        writeText(", tlb hit\n", 10);
+    else if (pageTableHit)
+        writeText(", tlb miss, pagetable hit\n", 26);
+    else
+        writeText(", tlb miss, pagetable miss\n", 27);
+}
+
+/**
+ * Writes the line of vpn2pfn mode, the page index of every level and then the frame
+ */
+inline void OutputWriter::writeVpn2pfn(unsigned int levels, const unsigned int* pages, unsigned int frame) {
+    reserveLine();
+    for (unsigned int i = 0; i < levels; i++) {
+        writeHex(pages[i], 1);
+        *cursor++ = ' ';
+    }
+    writeText("-> ", 3);
+    writeHex(frame, 1);
+    *cursor++ = '\n';
+}
+
+/**
+ * Writes the line of offset mode, the page offset of the address
+ */
+inline void OutputWriter::writeOffset(uint64_t offset) {
+    reserveLine();
+    writeHex(offset, 8);
+    *cursor++ = '\n';
+}
+
+#endif
@@ -1,17 +1,132 @@
 //This is the work of Teddy Barker
 
 #include "pageTable.h"
-#include "level.h"
-#include <iostream>
+#include "levelPageTable.h"
+#include "hashedPageTable.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
+/*
+ * Batch decomposition kernels. Each splits the addresses of count trace records
+ * into their VPN, offset and page index on every level, skipping any output that
+ * is nullptr. The page indices are stored level by level, the index of record i
+ * on level l at pageIndices[l * count + i], so every store is contiguous.
+ */
+template <class RECORD>
+static void decomposeScalar(PageTable* pageTable, const RECORD* records, size_t count, uint64_t* vpns,
+                            uint64_t* offsets, unsigned int* pageIndices) {
+    unsigned int levels = pageTable->getLevelCount();
+    uint64_t* bitMaskAry = pageTable->getBitMaskAry();
+    unsigned int* shiftAry = pageTable->getShiftAry();
+    uint64_t addressMask = pageTable->getAddressMask();
+    unsigned int offsetShift = shiftAry[levels - 1];
+    uint64_t offsetMask = ((uint64_t) 1 << offsetShift) - 1;
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t address = records[i].addr;
+        if (vpns != nullptr)
+            vpns[i] = (address & addressMask) >> offsetShift;
+        if (offsets != nullptr)
+            offsets[i] = address & offsetMask;
+        if (pageIndices != nullptr) {
+            for (unsigned int level = 0; level < levels; level++)
+                pageIndices[level * count + i] = (address & bitMaskAry[level]) >> shiftAry[level];
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+//Gathers the 32 bit addresses of 4 records into 64 bit lanes, the records are 3 words apart
+__attribute__((target("avx2")))
+static inline __m256i loadAddresses(const p2AddrTr* records) {
+    const int stride = sizeof(p2AddrTr) / sizeof(uint32_t);
+    __m128i addresses = _mm_i32gather_epi32((const int*) records, _mm_setr_epi32(0, stride, 2 * stride, 3 * stride), 4);
+    return _mm256_cvtepu32_epi64(addresses);
+}
+
+//Loads 4 records of 16 bytes and keeps the address in the low half of each
+__attribute__((target("avx2")))
+static inline __m256i loadAddresses(const p2AddrTr64* records) {
+    __m256i first = _mm256_loadu_si256((const __m256i*) records);
+    __m256i second = _mm256_loadu_si256((const __m256i*) (records + 2));
+
+    //The unpack takes records 0, 2, 1 and 3, so the middle two are swapped back
+    return _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <class RECORD>
+__attribute__((target("avx2")))
+static void decomposeAVX2(PageTable* pageTable, const RECORD* records, size_t count, uint64_t* vpns,
+                          uint64_t* offsets, unsigned int* pageIndices) {
+    unsigned int levels = pageTable->getLevelCount();
+    uint64_t* bitMaskAry = pageTable->getBitMaskAry();
+    unsigned int* shiftAry = pageTable->getShiftAry();
+    uint64_t addressMask = pageTable->getAddressMask();
+    unsigned int offsetShift = shiftAry[levels - 1];
+    uint64_t offsetMask = ((uint64_t) 1 << offsetShift) - 1;
+
+    __m256i addressMasks = _mm256_set1_epi64x(addressMask);
+    __m256i offsetMasks = _mm256_set1_epi64x(offsetMask);
+    __m128i vpnShift = _mm_cvtsi32_si128(offsetShift);
+
+    //Takes the low half of every 64 bit lane of two registers, in address order
+    __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    size_t i = 0;
+    for (; i + DECOMPOSE_STEP <= count; i += DECOMPOSE_STEP) {
+        __m256i first = loadAddresses(records + i);
+        __m256i second = loadAddresses(records + i + 4);
+
+        if (vpns != nullptr) {
+            _mm256_storeu_si256((__m256i*) (vpns + i), _mm256_srl_epi64(_mm256_and_si256(first, addressMasks), vpnShift));
+            _mm256_storeu_si256((__m256i*) (vpns + i + 4), _mm256_srl_epi64(_mm256_and_si256(second, addressMasks), vpnShift));
+        }
+        if (offsets != nullptr) {
+            _mm256_storeu_si256((__m256i*) (offsets + i), _mm256_and_si256(first, offsetMasks));
+            _mm256_storeu_si256((__m256i*) (offsets + i + 4), _mm256_and_si256(second, offsetMasks));
+        }
+        if (pageIndices != nullptr) {
+            for (unsigned int level = 0; level < levels; level++) {
+                __m256i mask = _mm256_set1_epi64x(bitMaskAry[level]);
+                __m128i shift = _mm_cvtsi32_si128(shiftAry[level]);
+                __m256i low = _mm256_srl_epi64(_mm256_and_si256(first, mask), shift);
+                __m256i high = _mm256_srl_epi64(_mm256_and_si256(second, mask), shift);
+
+                //An index fits 32 bits, so the second register's go in the upper half of each lane
+                __m256i packed = _mm256_or_si256(low, _mm256_slli_epi64(high, 32));
+                _mm256_storeu_si256((__m256i*) (pageIndices + level * count + i),
+                                    _mm256_permutevar8x32_epi32(packed, lowHalves));
+            }
+        }
+    }
+
+    //The records past the last whole step
+    for (; i < count; i++) {
+        uint64_t address = records[i].addr;
+        if (vpns != nullptr)
+            vpns[i] = (address & addressMask) >> offsetShift;
+        if (offsets != nullptr)
+            offsets[i] = address & offsetMask;
+        if (pageIndices != nullptr) {
+            for (unsigned int level = 0; level < levels; level++)
+                pageIndices[level * count + i] = (address & bitMaskAry[level]) >> shiftAry[level];
+        }
+    }
+}
+#endif
+
 /*****************
 ** CONSTRUCTORS **
 *****************/
-PageTable::PageTable(unsigned int levelCount, unsigned int* entryCount) {
+PageTable::PageTable(unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits) {
     //Setting members to paramater values
     this->levelCount = levelCount;
+    this->addressBits = addressBits;
     this->entryCount = new unsigned int[levelCount];
     for(int i = 0; i < levelCount; i++)
         this->entryCount[i] = entryCount[i];
@@ -19,7 +134,7 @@ PageTable::PageTable(unsigned int levelCount, unsigned int* entryCount) {
 
     //Build a Shift Array corresponding to the # of bits to shift for getting level i page index
 
-    unsigned int bitSizeTemp = BIT_SIZE; //Helper variable to start at BIT_SIZE and count the shifts necessary for i level
+    unsigned int bitSizeTemp = addressBits; //Helper variable to start at the address width and count the shifts necessary for i level
 
     shiftAry = new unsigned int[levelCount]; //Allocate shiftAry with size equal to the amount of levels
 
@@ -32,7 +147,7 @@ PageTable::PageTable(unsigned int levelCount, unsigned int* entryCount) {
     }
 
     //Build a Bitmask Array corresponding to the entryCount
-    bitMaskAry = new unsigned int[levelCount];
+    bitMaskAry = new uint64_t[levelCount];
     for(int i = 0; i < levelCount; i++) {
         //Build a bitmask for the given level (entryCount[i])
         bitMaskAry[i] = 0;
@@ -50,70 +165,67 @@ PageTable::PageTable(unsigned int levelCount, unsigned int* entryCount) {
             bitMaskAry[i] = bitMaskAry[i] << shiftAry[i];
     }
 
-    //Allocating new root level
-    root = new Level(0, entryCount[0], this);
-
-    for(int i = 0; i < entryCount[0]; i++) {
-        root->nextPtr[i] = nullptr;
-    }
-
     //Initializing the starting pfn and frames allocated to 0
     nextAvailablePFN = 0;
     framesAllocated = 0;
+    frameTable = nullptr;
+
+    decomposeKernel = decomposeScalar<p2AddrTr>;
+    decomposeKernel64 = decomposeScalar<p2AddrTr64>;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        decomposeKernel = decomposeAVX2<p2AddrTr>;
+        decomposeKernel64 = decomposeAVX2<p2AddrTr64>;
+    }
+#endif
+}
+
+PageTable::~PageTable() {
+    delete[] entryCount;
+    delete[] shiftAry;
+    delete[] bitMaskAry;
 }
 
 /************
 ** METHODS **
 ************/
 /**
- * This is the bread and butter.
- * Returns the integer for the physical frame number for this vpn
- *  it also tracks pagetable hit or miss using the flag
+ * Returns a new, empty page table of this backend
  */
-unsigned int PageTable::recordPageAccess(unsigned int address, Level* level, bool &flag) {
-    //Temporary int masked with the first bitmask
-    unsigned int masked = address & bitMaskAry[level->depth];
-
-    //Right shift to find offset on this level
-    masked = masked >> shiftAry[level->depth];
-
-    if(level->depth == levelCount - 1) {
-        //This is the leaf level, so handle the PFN assignment here
-        if(level->nextPtr[masked] == nullptr) {
-                //Create a new leaf node and assign the next available PFN
-                level->nextPtr[masked] = new Level(level->depth + 1, 0, this);
-
-                //Store the PFN at the leaf node by using the next available PFN
-                level->nextPtr[masked]->pfn = nextAvailablePFN++; 
-                //Update pagetable hit flag
-                flag = false;
-
-                //Record the Newly allocated fram
-                framesAllocated++;
-                //Return the pfn
-                return level->nextPtr[masked]->pfn;
+PageTable* PageTable::create(PageTableBackend backend, unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits) {
+    switch (backend) {
+        case BACKEND_HASHED:
+            return new HashedPageTable(levelCount, entryCount, addressBits);
+        case BACKEND_ADAPTIVE:
+            return new LevelPageTable(levelCount, entryCount, addressBits, true);
+        default:
+            return new LevelPageTable(levelCount, entryCount, addressBits, false);
+    }
+}
 
+/**
+ * Looks up a backend by its command line name, returns false if there is none by that name
+ */
+bool PageTable::parse(const char* name, PageTableBackend& backend) {
+    static const char* names[] = { "levels", "hashed", "adaptive" };
+    static const PageTableBackend backends[] = { BACKEND_LEVELS, BACKEND_HASHED, BACKEND_ADAPTIVE };
+
+    for (int i = 0; i < 3; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            backend = backends[i];
+            return true;
         }
-        //Update pagetable hit flag
-        flag = true;
-        //Return the PFN stored in this leaf node
-        return level->nextPtr[masked]->pfn;
-    } else if(level->nextPtr[masked] != nullptr) {
-        //Continue to the next level
-        return recordPageAccess(address, level->nextPtr[masked], flag);
-    } else {
-        //Add the next level
-        level->nextPtr[masked] = new Level(level->depth + 1, entryCount[level->depth + 1], this);
-        return recordPageAccess(address, level->nextPtr[masked], flag);
     }
+    return false;
 }
 
 /**
  * Returns the vpn based upon a given address and masking style
  */
-unsigned int PageTable::extractPageNumberFromAddress(unsigned int address, unsigned intmask, unsigned int shift) {
+unsigned int PageTable::extractPageNumberFromAddress(uint64_t address, uint64_t intmask, unsigned int shift) {
     //Temporary int masked with the first bitmask
-    unsigned int masked = address & intmask;
+    uint64_t masked = address & intmask;
 
     //Right shift to find offset on this level
     masked = masked >> shift;
@@ -121,31 +233,6 @@ unsigned int PageTable::extractPageNumberFromAddress(unsigned int address, unsig
     return masked;
 }
 
-/**
- * Getter for the total page table entries
- */
-unsigned long PageTable::getTotalPageTableEntries() {
-    return countEntriesAtLevel(root);  //Start counting from the root
-}
-
-/**
- * Returns the entry count at this level and all levels below it
- */
-unsigned long PageTable::countEntriesAtLevel(Level* level) {
-    if (level == nullptr) return 1;
-
-    //Count the level, not the root
-    int count = 0;
-    if(level != root)
-        count = 1;
-    
-    //Recursively count entries in the next levels
-    for (unsigned int i = 0; i < level->size; i++) {
-        count += countEntriesAtLevel(level->nextPtr[i]);
-    }
-    return count;
-}
-
 /**
  * Helper Function for a bitwise log base 2
  */
@@ -164,7 +251,7 @@ unsigned int PageTable::bitwiseLog2(unsigned int num) {
 /**
  * Getter for Bit mask array
  */
-unsigned int* PageTable::getBitMaskAry() {
+uint64_t* PageTable::getBitMaskAry() {
     return bitMaskAry;
 }
 
@@ -177,10 +264,69 @@ unsigned int* PageTable::getShiftAry() {
 }
 
 /**
- * Getter for root level
+ * Getter for the number of levels
+ */
+unsigned int PageTable::getLevelCount() {
+    return levelCount;
+}
+
+/**
+ * Getter for the width of the virtual addresses, in bits
+ */
+unsigned int PageTable::getAddressBits() {
+    return addressBits;
+}
+
+/**
+ * Returns the mask of the address bits the page table translates, the
+ * levels and the offset below them, dropping any sign extension above
+ */
+uint64_t PageTable::getAddressMask() {
+    return bitMaskAry[0] | (bitMaskAry[0] - 1);
+}
+
+/**
+ * Splits the addresses of count records at once into their VPN, offset and page index
+ * on every level, with AVX2 DECOMPOSE_STEP addresses at a time when the CPU has it. Any
+ * of the outputs may be nullptr to skip it. pageIndices holds count indices per level,
+ * level by level
+ */
+void PageTable::decomposeBatch(const p2AddrTr* records, size_t count, uint64_t* vpns, uint64_t* offsets,
+                               unsigned int* pageIndices) {
+    decomposeKernel(this, records, count, vpns, offsets, pageIndices);
+}
+
+/**
+ * Splits the addresses of count 64 bit records at once, as above
+ */
+void PageTable::decomposeBatch(const p2AddrTr64* records, size_t count, uint64_t* vpns, uint64_t* offsets,
+                               unsigned int* pageIndices) {
+    decomposeKernel64(this, records, count, vpns, offsets, pageIndices);
+}
+
+/**
+ * Bounds physical memory to the frames of this table, which the caller keeps
  */
-Level* PageTable::getRoot() {
-    return root;
+void PageTable::setFrameTable(FrameTable* frameTable) {
+    this->frameTable = frameTable;
+}
+
+/**
+ * Takes a frame from the frame table for a newly mapped VPN, evicting the page
+ * of another one once every frame is in use
+ */
+unsigned int PageTable::replaceFrame(uint64_t vpn, Level* level, unsigned int index) {
+    unsigned int pfn;
+    if (!frameTable->isFull()) {
+        pfn = frameTable->claim();
+        framesAllocated++;
+    } else {
+        pfn = frameTable->evict();
+        unmapPage(frameTable->getOwner(pfn));
+    }
+
+    frameTable->setOwner(pfn, vpn, level, index);
+    return pfn;
 }
 
 /**
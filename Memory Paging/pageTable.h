@@ -3,41 +3,112 @@
 #ifndef PAGETABLE_H
 #define PAGETABLE_H
 
-#include "level.h"
+#include <stddef.h>
+#include <stdint.h>
+#include "frameTable.h"
+#include "tracereader.h"
+
+//Addresses the AVX2 batch decomposition splits per step, two registers of 4
+#define DECOMPOSE_STEP 8
 
 //BIT SIZE MACRO FOR THE MEMORY ADDRESSES:
 #define BIT_SIZE 32
 
+//Widest virtual address space, the 64 bit trace format may use any width up to this
+#define MAX_BIT_SIZE 64
+
+//Widest page table level and page offset, so 1 << bits still fits an unsigned int
+#define MAX_FIELD_BITS 28
+#define MAX_OFFSET_BITS 31
+
+//Ways a page table can be laid out in memory, picked with -b
+enum PageTableBackend {
+    BACKEND_LEVELS,
+    BACKEND_HASHED,
+    BACKEND_ADAPTIVE
+};
+
 /*
  * Page Table class
- *   A descriptor containing the attributes of a N level page 
- *   table and a pointer to the root level (Level 0) object.
+ *   A descriptor containing the attributes of a N level page table:
+ *   the width of the virtual addresses it translates, BIT_SIZE for the
+ *   BYU traces, the level sizes, the bitmask and shift of every level and the frames
+ *   handed out so far. How the VPN -> PFN mappings are stored is up to
+ *   each backend, use create to get the one selected on the command line.
+ *
+ *   Frames come from an endless supply unless the page table is given a
+ *   frame table, then a new page past the last frame evicts another one
+ *   and the backend unmaps it.
 */
 class PageTable {
     public:
-        PageTable(unsigned int levelCount, unsigned int* entryCount);
+        PageTable(unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits);
+        virtual ~PageTable();
+
+        //The page table owns its storage, so it can not be copied
+        PageTable(const PageTable&) = delete;
+        PageTable& operator=(const PageTable&) = delete;
 
-        unsigned int recordPageAccess(unsigned int address, Level * level, bool &flag);
-        unsigned int extractPageNumberFromAddress(unsigned int address, unsigned intmask, unsigned int shift);
+        //Returns the PFN for the page of this address, mapping a new frame on a miss, the flag is set on a pagetable hit
+        virtual unsigned int recordPageAccess(uint64_t address, bool &flag) = 0;
 
-        Level* getRoot();
-        unsigned int* getBitMaskAry();
+        virtual PageTableBackend getBackend() = 0;
+        virtual unsigned long getTotalPageTableEntries() = 0;
+        virtual unsigned long getLevelsAllocated() = 0;
+        virtual size_t getBytesUsed() = 0;
+
+        //Removes the mapping of an evicted frame, its entry is left unmapped
+        virtual void unmapPage(const FrameOwner& owner) = 0;
+
+        unsigned int extractPageNumberFromAddress(uint64_t address, uint64_t intmask, unsigned int shift);
+        void decomposeBatch(const p2AddrTr* records, size_t count, uint64_t* vpns, uint64_t* offsets,
+                            unsigned int* pageIndices);
+        void decomposeBatch(const p2AddrTr64* records, size_t count, uint64_t* vpns, uint64_t* offsets,
+                            unsigned int* pageIndices);
+
+        unsigned int getLevelCount();
+        unsigned int getAddressBits();
+        uint64_t getAddressMask();
+        uint64_t* getBitMaskAry();
         unsigned int* getShiftAry();
         unsigned int getFramesAllocated();
-        unsigned long getTotalPageTableEntries();
-        unsigned long countEntriesAtLevel(Level* level);
+        void setFrameTable(FrameTable* frameTable);
 
+        static PageTable* create(PageTableBackend backend, unsigned int levelCount, unsigned int* entryCount, unsigned int addressBits);
+        static bool parse(const char* name, PageTableBackend& backend);
 
-    private:
+    protected:
         unsigned int levelCount;
-        unsigned int* bitMaskAry;
+        unsigned int addressBits;
+        uint64_t* bitMaskAry;
         unsigned int* shiftAry;
         unsigned int* entryCount;
-        Level* root;
         unsigned int framesAllocated;
         unsigned int nextAvailablePFN;
+        FrameTable* frameTable; //Bounded physical memory, nullptr for an endless supply of frames
 
+        //Batch decomposition of each trace format, AVX2 when the CPU has it and scalar otherwise
+        void (*decomposeKernel)(PageTable* pageTable, const p2AddrTr* records, size_t count, uint64_t* vpns,
+                                uint64_t* offsets, unsigned int* pageIndices);
+        void (*decomposeKernel64)(PageTable* pageTable, const p2AddrTr64* records, size_t count, uint64_t* vpns,
+                                  uint64_t* offsets, unsigned int* pageIndices);
+
+        unsigned int allocateFrame(uint64_t vpn, Level* level, unsigned int index);
+        unsigned int replaceFrame(uint64_t vpn, Level* level, unsigned int index);
         unsigned int bitwiseLog2(unsigned int num);
 };
 
-#endif
\ No newline at end of file
+/**
+ * Returns a frame for a newly mapped VPN, mapped by entry index of this leaf
+ * level, or a null level in a hashed page table. Defined here so that the
+ * backends can inline it
+ */
+inline unsigned int PageTable::allocateFrame(uint64_t vpn, Level* level, unsigned int index) {
+    if (frameTable == nullptr) {
+        framesAllocated++;
+        return nextAvailablePFN++;
+    }
+    return replaceFrame(vpn, level, index);
+}
+
+#endif
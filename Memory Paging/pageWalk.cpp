@@ -0,0 +1,37 @@
+//This is the work of Teddy Barker
+
+#include "pageWalk.h"
+
+/**
+ * Returns a new WALKER for this page table, specialized on its level
+ * count up to MAX_SPECIALIZED_LEVELS and read at run time beyond that
+ */
+template <template <unsigned int> class WALKER>
+static PageWalk* createWalker(PageTable* pageTable, PageWalkCache* walkCache) {
+    switch (pageTable->getLevelCount()) {
+        case 1:
+            return new WALKER<1>(pageTable, walkCache);
+        case 2:
+            return new WALKER<2>(pageTable, walkCache);
+        case 3:
+            return new WALKER<3>(pageTable, walkCache);
+        case 4:
+            return new WALKER<4>(pageTable, walkCache);
+        case 5:
+            return new WALKER<5>(pageTable, walkCache);
+        case 6:
+            return new WALKER<6>(pageTable, walkCache);
+        default:
+            return new WALKER<0>(pageTable, walkCache);
+    }
+}
+
+/**
+ * Returns a new page walk for this page table, the walker of its backend
+ * specialized on its level count. walkCache may be nullptr for none
+ */
+PageWalk* PageWalk::create(PageTable* pageTable, PageWalkCache* walkCache) {
+    if (pageTable->getBackend() == BACKEND_HASHED)
+        return createWalker<HashedPageWalker>(pageTable, walkCache);
+    return createWalker<PageWalker>(pageTable, walkCache);
+}
@@ -0,0 +1,209 @@
+//This is the work of Teddy Barker
+
+#ifndef PAGEWALK_H
+#define PAGEWALK_H
+
+#include "levelPageTable.h"
+#include "hashedPageTable.h"
+#include "pageWalkCache.h"
+
+//Upper bound on the page table levels, every level uses at least one bit
+#define MAX_LEVELS MAX_BIT_SIZE
+
+//Deepest page table that gets a walk specialized on its level count
+#define MAX_SPECIALIZED_LEVELS 6
+
+/**
+ * This Struct holds the result of translating one address:
+ *  - virtual and physical address
+ *  - virtual page number, its page index on every level and the offset
+ *  - physical frame number
+ *  - whether a TLB or the page table held the mapping, and which TLB level
+ *  - whether the page is part of a huge page, and whether this walk promoted it
+ */
+struct Translation {
+    uint64_t vAddr;
+    uint64_t pAddr;
+    uint64_t vpn;
+    unsigned int pageIndices[MAX_LEVELS];
+    uint64_t offset;
+    unsigned int pfn;
+    bool tlbHit;
+    unsigned char tlbLevel; //1 for an L1 TLB, 2 for the unified TLB, 0 for a miss
+    bool pageTableHit;
+    bool hugePage;
+    bool promoted;
+};
+
+/*
+ * Page Walk class
+ *   Splits addresses into their page indices and walks the page table
+ *   with them. Use create to get the walk for a page table, which picks
+ *   the walker of its backend specialized on the level count when there
+ *   is one, starting from a page walk cache if it is given one.
+*/
+class PageWalk {
+    public:
+        virtual ~PageWalk() {}
+
+        //Fills in the page indices, VPN and offset of vAddr in one pass
+        virtual void decompose(uint64_t vAddr, Translation& result) = 0;
+
+        //Walks the page table with the decomposed indices, filling in the PFN and the pagetable hit flag
+        virtual void walk(Translation& result) = 0;
+
+        static PageWalk* create(PageTable* pageTable, PageWalkCache* walkCache);
+};
+
+/*
+ * Page Decomposer class
+ *   The part of a page walk shared by every backend, splitting addresses
+ *   into their page indices. The masks and shifts are copied into the
+ *   walker, and with LEVELS known at compile time every loop below
+ *   unrolls so they stay in registers for the whole walk. LEVELS of 0
+ *   gives the walker for any level count, read at run time.
+*/
+template <unsigned int LEVELS>
+class PageDecomposer : public PageWalk {
+    public:
+        PageDecomposer(PageTable* pageTable) {
+            levelCount = LEVELS ? LEVELS : pageTable->getLevelCount();
+
+            for (unsigned int i = 0; i < levelCount; i++) {
+                bitMaskAry[i] = pageTable->getBitMaskAry()[i];
+                shiftAry[i] = pageTable->getShiftAry()[i];
+            }
+            offsetMask = ((uint64_t) 1 << shiftAry[levelCount - 1]) - 1;
+            addressMask = pageTable->getAddressMask();
+        }
+
+        void decompose(uint64_t vAddr, Translation& result) {
+            const unsigned int levels = LEVELS ? LEVELS : levelCount;
+
+            result.vAddr = vAddr;
+            for (unsigned int i = 0; i < levels; i++) {
+                result.pageIndices[i] = (vAddr & bitMaskAry[i]) >> shiftAry[i];
+            }
+
+            //The levels cover every bit of the address width above the offset, so the VPN is those bits.
+            //Bits above the width, such as the sign extension of a canonical address, are not translated
+            result.vpn = (vAddr & addressMask) >> shiftAry[levels - 1];
+            result.offset = vAddr & offsetMask;
+        }
+
+    protected:
+        unsigned int levelCount;
+        uint64_t bitMaskAry[LEVELS ? LEVELS : MAX_LEVELS];
+        unsigned int shiftAry[LEVELS ? LEVELS : MAX_LEVELS];
+        uint64_t offsetMask;
+        uint64_t addressMask;
+};
+
+/*
+ * Page Walker class
+ *   The page walk for a radix tree of LEVELS levels, one child pointer
+ *   per level down to the leaf that holds the PFN. With a page walk
+ *   cache the walk starts at the deepest level it holds for the VPN and
+ *   caches every level it has to step into below that. With huge pages
+ *   the walk stops at a promoted level, and promotes the level above a
+ *   newly mapped page once enough pages below it are mapped.
+*/
+template <unsigned int LEVELS>
+class PageWalker : public PageDecomposer<LEVELS> {
+    public:
+        PageWalker(PageTable* pageTable, PageWalkCache* walkCache) : PageDecomposer<LEVELS>(pageTable) {
+            this->pageTable = (LevelPageTable*) pageTable;
+            this->walkCache = walkCache;
+
+            //Without huge pages no walk reaches the huge page depth
+            hugePageDepth = this->pageTable->getHugePageDepth();
+            if (hugePageDepth == 0)
+                hugePageDepth = this->levelCount;
+            hugePageMask = this->pageTable->getHugePageFrames() - 1;
+        }
+
+        void walk(Translation& result) {
+            const unsigned int levels = LEVELS ? LEVELS : this->levelCount;
+
+            if (walkCache != nullptr || hugePageDepth < levels) {
+                walkModelled(result);
+                return;
+            }
+
+            Level* level = pageTable->getRoot();
+            for (unsigned int i = 0; i < levels - 1; i++) {
+                level = pageTable->nextLevel(level, result.pageIndices[i]);
+            }
+            result.pfn = pageTable->mapPage(level, result.pageIndices[levels - 1], result.vpn, result.pageTableHit);
+        }
+
+    private:
+        LevelPageTable* pageTable;
+        PageWalkCache* walkCache;
+        unsigned int hugePageDepth;
+        unsigned int hugePageMask;
+
+        //The walk with a page walk cache or huge pages, which never start below the huge page depth
+        void walkModelled(Translation& result) {
+            const unsigned int levels = LEVELS ? LEVELS : this->levelCount;
+
+            Level* level = pageTable->getRoot();
+            unsigned int i = (walkCache != nullptr) ? walkCache->lookup(result.vpn, level) : 0;
+            Level* hugePageLevel = nullptr;
+            for (; i < levels - 1; i++) {
+                if (i == hugePageDepth) {
+                    if (level->hugePfn != INVALID_PFN)
+                        break;
+                    hugePageLevel = level;
+                }
+                level = pageTable->nextLevel(level, result.pageIndices[i]);
+                if (walkCache != nullptr)
+                    walkCache->insert(i, result.vpn, level);
+            }
+
+            //A leaf can be at the huge page depth too
+            if (i == hugePageDepth) {
+                if (level->hugePfn != INVALID_PFN) {
+                    result.pfn = level->hugePfn + (result.vpn & hugePageMask);
+                    result.pageTableHit = true;
+                    result.hugePage = true;
+                    return;
+                }
+                hugePageLevel = level;
+            }
+
+            result.pfn = pageTable->mapPage(level, result.pageIndices[levels - 1], result.vpn, result.pageTableHit);
+
+            //Count a newly mapped page towards the huge page around it
+            if (!result.pageTableHit && hugePageLevel != nullptr &&
+                ++hugePageLevel->pagesMapped >= pageTable->getHugePageThreshold()) {
+                pageTable->promote(hugePageLevel);
+                result.pfn = hugePageLevel->hugePfn + (result.vpn & hugePageMask);
+                result.hugePage = true;
+                result.promoted = true;
+            }
+        }
+};
+
+/*
+ * Hashed Page Walker class
+ *   The page walk for a hashed page table, a single lookup of the whole
+ *   VPN. The page indices are still split out for the outputs that show them.
+ *   There are no upper levels to cache, so it never uses a page walk cache.
+*/
+template <unsigned int LEVELS>
+class HashedPageWalker : public PageDecomposer<LEVELS> {
+    public:
+        HashedPageWalker(PageTable* pageTable, PageWalkCache* /*walkCache*/) : PageDecomposer<LEVELS>(pageTable) {
+            this->pageTable = (HashedPageTable*) pageTable;
+        }
+
+        void walk(Translation& result) {
+            result.pfn = pageTable->mapPage(result.vpn, result.pageTableHit);
+        }
+
+    private:
+        HashedPageTable* pageTable;
+};
+
+#endif
@@ -0,0 +1,118 @@
+//This is the work of Teddy Barker
+
+#include "pageWalkCache.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+/**
+ * Builds a cache of sizes[i] entries for each upper level i of the page table,
+ * a size of 0 leaves that level uncached
+ */
+PageWalkCache::PageWalkCache(PageTable* pageTable, const vector<unsigned int>& sizes) {
+    levelCount = pageTable->getLevelCount();
+    unsigned int* shiftAry = pageTable->getShiftAry();
+
+    caches.resize(sizes.size());
+    for (unsigned int i = 0; i < caches.size(); i++) {
+        WalkCacheLevel& cache = caches[i];
+        cache.size = sizes[i];
+        cache.tags = new uint64_t[cache.size];
+        cache.levels = new Level*[cache.size];
+        cache.lastUse = new unsigned long[cache.size];
+        for (unsigned int way = 0; way < cache.size; way++) {
+            cache.tags[way] = WALK_CACHE_INVALID_TAG;
+            cache.levels[way] = nullptr;
+            cache.lastUse[way] = 0;
+        }
+
+        //The prefix drops the indices of the levels below this one from the VPN
+        cache.prefixShift = shiftAry[i] - shiftAry[levelCount - 1];
+        cache.mostRecent = 0;
+        cache.hits = 0;
+    }
+
+    now = 0;
+    walks = 0;
+    stepsSaved = 0;
+}
+
+PageWalkCache::~PageWalkCache() {
+    for (unsigned int i = 0; i < caches.size(); i++) {
+        delete[] caches[i].tags;
+        delete[] caches[i].levels;
+        delete[] caches[i].lastUse;
+    }
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Getter for the number of upper levels with a cache entry count, cached or not
+ */
+unsigned int PageWalkCache::getCacheLevels() {
+    return caches.size();
+}
+
+/**
+ * Getter for the entries in the cache of this level
+ */
+unsigned int PageWalkCache::getSize(unsigned int cacheLevel) {
+    return caches[cacheLevel].size;
+}
+
+/**
+ * Getter for the walks that started from the cache of this level, skipping cacheLevel + 1 levels
+ */
+unsigned long PageWalkCache::getHits(unsigned int cacheLevel) {
+    return caches[cacheLevel].hits;
+}
+
+/**
+ * Getter for the number of page walks that looked in the cache
+ */
+unsigned long PageWalkCache::getWalks() {
+    return walks;
+}
+
+/**
+ * Getter for the page table entries the walks did not have to read
+ */
+unsigned long PageWalkCache::getStepsSaved() {
+    return stepsSaved;
+}
+
+/**
+ * Getter for the page table entries the walks would have read without the cache, one per level
+ */
+unsigned long PageWalkCache::getSteps() {
+    return walks * levelCount;
+}
+
+/**
+ * Parses a comma separated list of entry counts, one for each upper level
+ * from the root down, such as 4,32,32. Returns false if any is not a number
+ */
+bool PageWalkCache::parse(const char* sizes, vector<unsigned int>& entries) {
+    entries.clear();
+
+    const char* cursor = sizes;
+    while (true) {
+        char* end;
+        long size = strtol(cursor, &end, 10);
+        if (end == cursor || size < 0)
+            return false;
+        entries.push_back(size);
+
+        if (*end == '\0')
+            return true;
+        if (*end != ',')
+            return false;
+        cursor = end + 1;
+    }
+}
@@ -0,0 +1,127 @@
+//This is the work of Teddy Barker
+
+#ifndef PAGEWALKCACHE_H
+#define PAGEWALKCACHE_H
+
+#include <stdint.h>
+#include <vector>
+#include "pageTable.h"
+#include "level.h"
+
+//Tag of an empty cache entry, no VPN prefix is all ones
+#define WALK_CACHE_INVALID_TAG 0xFFFFFFFFFFFFFFFFull
+
+/**
+ * This Struct holds the cache of one upper level of the page table:
+ *  - the VPN prefix of each entry, the page indices down to this level
+ *  - the Level object that prefix leads to, one level further down
+ *  - the time of each entry's last use, for LRU replacement
+ *  - the entry used last, checked before the others
+ *  - how far the VPN is shifted to get the prefix
+ *  - walks that started from this cache
+ */
+struct WalkCacheLevel {
+    unsigned int size;
+    uint64_t* tags;
+    Level** levels;
+    unsigned long* lastUse;
+    unsigned int mostRecent;
+    unsigned int prefixShift;
+    unsigned long hits;
+};
+
+/*
+ * Page Walk Cache class
+ *   Models the paging-structure caches of x86-64 and the walk caches of
+ *   AArch64. Each upper level of a radix tree page table gets a small
+ *   fully associative LRU cache from the VPN prefix that indexes down to
+ *   it to the Level object one step below, so a walk can start at the
+ *   deepest level it finds instead of the root. A walk that starts at
+ *   depth d skips the d entries above it. The leaf level is left to the
+ *   TLB, it caches whole translations.
+*/
+class PageWalkCache {
+    public:
+        PageWalkCache(PageTable* pageTable, const std::vector<unsigned int>& sizes);
+        ~PageWalkCache();
+
+        //The cache owns its entries, so it can not be copied
+        PageWalkCache(const PageWalkCache&) = delete;
+        PageWalkCache& operator=(const PageWalkCache&) = delete;
+
+        unsigned int lookup(uint64_t vpn, Level*& level);
+        void insert(unsigned int cacheLevel, uint64_t vpn, Level* level);
+
+        unsigned int getCacheLevels();
+        unsigned int getSize(unsigned int cacheLevel);
+        unsigned long getHits(unsigned int cacheLevel);
+        unsigned long getWalks();
+        unsigned long getStepsSaved();
+        unsigned long getSteps();
+
+        static bool parse(const char* sizes, std::vector<unsigned int>& entries);
+
+    private:
+        std::vector<WalkCacheLevel> caches; //caches[i] maps the indices of levels 0 to i to the Level at depth i + 1
+        unsigned int levelCount;
+        unsigned long now;
+
+        unsigned long walks;
+        unsigned long stepsSaved;
+};
+
+/**
+ * Finds the deepest level that a cached prefix of vpn leads to and sets level to it.
+ * Returns its depth, the number of levels the walk skips, or 0 with level untouched
+ * on a miss in every cache. Defined here so that the page walkers can inline it
+ */
+inline unsigned int PageWalkCache::lookup(uint64_t vpn, Level*& level) {
+    walks++;
+    now++;
+
+    for (unsigned int i = caches.size(); i-- > 0; ) {
+        WalkCacheLevel& cache = caches[i];
+        if (cache.size == 0)
+            continue;
+
+        //Consecutive walks mostly share their prefix, so the entry used last usually matches
+        uint64_t tag = vpn >> cache.prefixShift;
+        unsigned int way = cache.mostRecent;
+        if (cache.tags[way] != tag) {
+            for (way = 0; way < cache.size && cache.tags[way] != tag; way++);
+            if (way == cache.size)
+                continue;
+            cache.mostRecent = way;
+        }
+
+        cache.lastUse[way] = now;
+        cache.hits++;
+        stepsSaved += i + 1;
+        level = cache.levels[way];
+        return i + 1;
+    }
+    return 0;
+}
+
+/**
+ * Caches the Level that the indices of levels 0 to cacheLevel of vpn lead to,
+ * replacing the least recently used entry of that level's cache
+ */
+inline void PageWalkCache::insert(unsigned int cacheLevel, uint64_t vpn, Level* level) {
+    if (cacheLevel >= caches.size() || caches[cacheLevel].size == 0)
+        return;
+
+    WalkCacheLevel& cache = caches[cacheLevel];
+    unsigned int victim = 0;
+    for (unsigned int way = 1; way < cache.size; way++) {
+        if (cache.lastUse[way] < cache.lastUse[victim])
+            victim = way;
+    }
+
+    cache.tags[victim] = vpn >> cache.prefixShift;
+    cache.levels[victim] = level;
+    cache.lastUse[victim] = now;
+    cache.mostRecent = victim;
+}
+
+#endif
@@ -0,0 +1,116 @@
+//This is the work of Teddy Barker
+
+#include <iostream>
+#include <cstdlib>
+#include <getopt.h>
+#include "resultReader.h"
+#include "outputWriter.h"
+
+#define NORMAL_EXIT 1
+
+using namespace std;
+
+void printHeader(const ResultHeader& header, size_t recordCount);
+void printSummary(const ResultRecord* records, size_t recordCount);
+
+//Reads a result file written with -O and prints its translations as va2pa_atc_ptwalk lines, or a summary of them
+int main(int argc, char *argv[]) {
+    size_t recordLimit = (size_t) -1;
+    bool showHeader = false;
+    bool showSummary = false;
+
+    //Parse command-line options
+    int option;
+    while ((option = getopt(argc, argv, "n:Hs")) != -1) {
+        switch (option) {
+            case 'n': //Limit the number of records
+                if (atoi(optarg) <= 0) {
+                    cerr << "Number of records must be a number, greater than 0.\n";
+                    exit(NORMAL_EXIT);
+                }
+                recordLimit = atoi(optarg);
+                break;
+            case 'H': //Describe the configuration first
+                showHeader = true;
+                break;
+            case 's': //Count the hits instead of printing every record
+                showSummary = true;
+                break;
+            default:
+                cerr << "Invalid argument\n";
+                exit(NORMAL_EXIT);
+        }
+    }
+
+    if (optind != argc - 1) {
+        cerr << "Usage: " << argv[0] << " [-H] [-s] [-n <records>] <<resultfile>>.\n";
+        exit(NORMAL_EXIT);
+    }
+
+    ResultReader reader;
+    string error;
+    if (!reader.open(argv[optind], error)) {
+        cerr << error << ".\n";
+        exit(NORMAL_EXIT);
+    }
+
+    const ResultRecord* records = reader.getRecords();
+    size_t recordCount = reader.getRecordCount();
+    if (recordCount > recordLimit) {
+        recordCount = recordLimit;
+    }
+
+    if (showHeader) {
+        printHeader(reader.getHeader(), reader.getRecordCount());
+    }
+
+    if (showSummary) {
+        printSummary(records, recordCount);
+    } else {
+        //The same lines the simulator writes in va2pa_atc_ptwalk mode
+        OutputWriter output(stdout);
+        for (size_t i = 0; i < recordCount; i++) {
+            output.writeVa2paAtcPtwalk(records[i].vAddr, records[i].pAddr, records[i].flags & RESULT_TLB_HIT,
+                                       records[i].flags & RESULT_PAGE_TABLE_HIT);
+        }
+    }
+
+    reader.close();
+    return 0;
+}
+
+//Method to describe the configuration the results were made with
+void printHeader(const ResultHeader& header, size_t recordCount) {
+    //Named in the order of PageTableBackend and ReplacementPolicyType
+    static const char* backends[] = { "levels", "hashed", "adaptive" };
+    static const char* policies[] = { "lru", "clock", "plru", "random", "arc" };
+
+    printf("Levels:");
+    for (unsigned int i = 0; i < header.levelCount; i++) {
+        printf(" %u", header.levelBits[i]);
+    }
+    printf(", address bits: %u, backend: %s\n", header.addressBits,
+           header.backend < 3 ? backends[header.backend] : "unknown");
+    printf("TLB capacity: %u, ways: %u, L1 instruction: %u, L1 data: %u, policy: %s\n",
+           header.tlbSize, header.tlbWays, header.itlbSize, header.dtlbSize,
+           header.tlbPolicy < 5 ? policies[header.tlbPolicy] : "unknown");
+    printf("Frame limit: %u, huge page level: %u, records: %zu\n", header.frameLimit, header.hugePageDepth, recordCount);
+    fflush(stdout);
+}
+
+//Method to count the TLB and page table hits of the records
+void printSummary(const ResultRecord* records, size_t recordCount) {
+    unsigned long tlbHits = 0;
+    unsigned long pageTableHits = 0;
+    unsigned long hugePages = 0;
+    for (size_t i = 0; i < recordCount; i++) {
+        tlbHits += records[i].flags & RESULT_TLB_HIT;
+        pageTableHits += (records[i].flags & RESULT_PAGE_TABLE_HIT) >> 1;
+        hugePages += (records[i].flags & RESULT_HUGE_PAGE) >> 2;
+    }
+
+    double hit_percent = recordCount ? (double) tlbHits / (double) recordCount * 100.0 : 0.0;
+    printf("Records: %zu, cache hits: %lu, page hits: %lu, misses: %lu, cache hit percentage: %.2f%%, huge page records: %lu\n",
+           recordCount, tlbHits, pageTableHits, recordCount - tlbHits - pageTableHits, hit_percent, hugePages);
+    fflush(stdout);
+}
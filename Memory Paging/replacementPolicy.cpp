@@ -0,0 +1,434 @@
+//This is the work of Teddy Barker
+
+#include "replacementPolicy.h"
+
+#include <cstring>
+
+using namespace std;
+
+/****************
+** REPLACEMENT **
+****************/
+/**
+ * Returns a new policy of this type for sets sets of ways ways each
+ */
+ReplacementPolicy* ReplacementPolicy::create(ReplacementPolicyType type, int sets, int ways) {
+    switch (type) {
+        case POLICY_CLOCK:
+            return new ClockPolicy(sets, ways);
+        case POLICY_PLRU:
+            return new TreePLRUPolicy(sets, ways);
+        case POLICY_RANDOM:
+            return new RandomPolicy(sets, ways);
+        case POLICY_ARC:
+            return new ARCPolicy(sets, ways);
+        default:
+            return new LRUPolicy(sets, ways);
+    }
+}
+
+/**
+ * Looks up a policy by its command line name, returns false if there is none by that name
+ */
+bool ReplacementPolicy::parse(const char* name, ReplacementPolicyType& type) {
+    static const char* names[] = { "lru", "clock", "plru", "random", "arc" };
+    static const ReplacementPolicyType types[] = { POLICY_LRU, POLICY_CLOCK, POLICY_PLRU, POLICY_RANDOM, POLICY_ARC };
+
+    for (int i = 0; i < 5; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            type = types[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+/********
+** LRU **
+********/
+LRUPolicy::LRUPolicy(int sets, int ways) {
+    this->ways = ways;
+    prev = new int[sets * ways];
+    next = new int[sets * ways];
+    mru = new int[sets];
+    lru = new int[sets];
+
+    for (int i = 0; i < sets * ways; i++) {
+        prev[i] = POLICY_NONE;
+        next[i] = POLICY_NONE;
+    }
+    for (int i = 0; i < sets; i++) {
+        mru[i] = POLICY_NONE;
+        lru[i] = POLICY_NONE;
+    }
+}
+
+LRUPolicy::~LRUPolicy() {
+    delete[] prev;
+    delete[] next;
+    delete[] mru;
+    delete[] lru;
+}
+
+//Move the way to the front of the set since it was accessed
+void LRUPolicy::touch(int set, int way) {
+    if (mru[set] != way) {
+        unlink(set, way);
+        pushFront(set, way);
+    }
+}
+
+//A filled way starts out most recently used
+void LRUPolicy::fill(int set, int way, uint64_t key) {
+    pushFront(set, way);
+}
+
+//Replace the least recently used way at the back of the set
+int LRUPolicy::victim(int set, uint64_t key) {
+    int way = lru[set];
+    unlink(set, way);
+    return way;
+}
+
+//An empty way leaves the list until it is filled again
+void LRUPolicy::invalidate(int set, int way) {
+    unlink(set, way);
+}
+
+//Take a way out of its set's list
+void LRUPolicy::unlink(int set, int way) {
+    int index = set * ways + way;
+
+    if (prev[index] != POLICY_NONE)
+        next[set * ways + prev[index]] = next[index];
+    else
+        mru[set] = next[index];
+
+    if (next[index] != POLICY_NONE)
+        prev[set * ways + next[index]] = prev[index];
+    else
+        lru[set] = prev[index];
+
+    prev[index] = POLICY_NONE;
+    next[index] = POLICY_NONE;
+}
+
+//Put a way at the most recently used end of its set's list
+void LRUPolicy::pushFront(int set, int way) {
+    int index = set * ways + way;
+
+    prev[index] = POLICY_NONE;
+    next[index] = mru[set];
+
+    if (mru[set] != POLICY_NONE)
+        prev[set * ways + mru[set]] = way;
+    else
+        lru[set] = way;
+
+    mru[set] = way;
+}
+
+/**********
+** CLOCK **
+**********/
+ClockPolicy::ClockPolicy(int sets, int ways) {
+    this->ways = ways;
+    referenced = new unsigned char[sets * ways]();
+    hand = new int[sets]();
+}
+
+ClockPolicy::~ClockPolicy() {
+    delete[] referenced;
+    delete[] hand;
+}
+
+//Give the way a second chance
+void ClockPolicy::touch(int set, int way) {
+    referenced[set * ways + way] = 1;
+}
+
+//A filled way was just accessed
+void ClockPolicy::fill(int set, int way, uint64_t key) {
+    referenced[set * ways + way] = 1;
+}
+
+//Sweep the hand to the first way that has not been referenced since the last sweep
+int ClockPolicy::victim(int set, uint64_t key) {
+    while (true) {
+        int way = hand[set];
+        hand[set] = (way + 1 == ways) ? 0 : way + 1;
+
+        if (!referenced[set * ways + way])
+            return way;
+        referenced[set * ways + way] = 0;
+    }
+}
+
+//An empty way has not been referenced
+void ClockPolicy::invalidate(int set, int way) {
+    referenced[set * ways + way] = 0;
+}
+
+/**************
+** TREE PLRU **
+**************/
+TreePLRUPolicy::TreePLRUPolicy(int sets, int ways) {
+    this->ways = ways;
+
+    //Round the leaves up to a power of 2, node 1 is the root and node n has children 2n and 2n + 1
+    leaves = 1;
+    while (leaves < ways)
+        leaves <<= 1;
+    bits = new unsigned char[sets * leaves]();
+}
+
+TreePLRUPolicy::~TreePLRUPolicy() {
+    delete[] bits;
+}
+
+//Point every bit on the path to this way at the other half
+void TreePLRUPolicy::touch(int set, int way) {
+    unsigned char* tree = bits + set * leaves;
+
+    for (int node = leaves + way; node > 1; node >>= 1)
+        tree[node >> 1] = !(node & 1); //Coming from the left child points right, and the other way around
+}
+
+//A filled way was just accessed
+void TreePLRUPolicy::fill(int set, int way, uint64_t key) {
+    touch(set, way);
+}
+
+//Follow the bits from the root down to a leaf
+int TreePLRUPolicy::victim(int set, uint64_t key) {
+    unsigned char* tree = bits + set * leaves;
+
+    int node = 1;
+    int first = 0; //First leaf under node
+    int span = leaves; //Leaves under node
+    while (node < leaves) {
+        span >>= 1;
+        bool right = tree[node];
+
+        //The right half may be nothing but padding past the last way
+        if (right && first + span >= ways)
+            right = false;
+
+        node = 2 * node + right;
+        first += right ? span : 0;
+    }
+    return node - leaves;
+}
+
+//The TLB fills empty ways before it asks for a victim, so the bits can stay
+void TreePLRUPolicy::invalidate(int set, int way) {
+}
+
+/***********
+** RANDOM **
+***********/
+RandomPolicy::RandomPolicy(int sets, int ways) {
+    this->ways = ways;
+    state = 0x9E3779B97F4A7C15ull; //Any nonzero seed
+}
+
+//Random replacement keeps no history
+void RandomPolicy::touch(int set, int way) {
+}
+
+void RandomPolicy::fill(int set, int way, uint64_t key) {
+}
+
+void RandomPolicy::invalidate(int set, int way) {
+}
+
+//Pick a way with an xorshift generator
+int RandomPolicy::victim(int set, uint64_t key) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return ((state * 2685821657736338717ull) >> 32) % ways;
+}
+
+/********
+** ARC **
+********/
+ARCPolicy::ARCPolicy(int sets, int ways) {
+    this->ways = ways;
+    arcSets = new ArcSet[sets];
+    prev = new int[sets * ways];
+    next = new int[sets * ways];
+    listOf = new unsigned char[sets * ways]();
+    keys = new uint64_t[sets * ways]();
+
+    for (int i = 0; i < sets * ways; i++) {
+        prev[i] = POLICY_NONE;
+        next[i] = POLICY_NONE;
+    }
+    for (int i = 0; i < sets; i++) {
+        for (int list = T1; list <= T2; list++) {
+            arcSets[i].mru[list] = POLICY_NONE;
+            arcSets[i].lru[list] = POLICY_NONE;
+            arcSets[i].size[list] = 0;
+        }
+        arcSets[i].target = 0;
+        arcSets[i].admitTo = POLICY_NONE;
+        arcSets[i].admittedFromB2 = false;
+        arcSets[i].t1Full = false;
+    }
+}
+
+ARCPolicy::~ARCPolicy() {
+    delete[] arcSets;
+    delete[] prev;
+    delete[] next;
+    delete[] listOf;
+    delete[] keys;
+}
+
+//A way seen again moves to the front of T2
+void ARCPolicy::touch(int set, int way) {
+    unlink(set, way);
+    pushFront(set, way, T2);
+}
+
+//The filled way joins the list its VPN was admitted to
+void ARCPolicy::fill(int set, int way, uint64_t key) {
+    ArcSet& arc = arcSets[set];
+
+    //The set was not full, so victim did not classify the key
+    if (arc.admitTo == POLICY_NONE)
+        admit(set, key);
+
+    keys[set * ways + way] = key;
+    pushFront(set, way, arc.admitTo);
+    arc.admitTo = POLICY_NONE;
+}
+
+//Make room for key in a full set
+int ARCPolicy::victim(int set, uint64_t key) {
+    ArcSet& arc = arcSets[set];
+    admit(set, key);
+
+    if (arc.t1Full) {
+        //T1 alone fills the set and B1 is empty, drop its LRU way without remembering it
+        int way = arc.lru[T1];
+        unlink(set, way);
+        return way;
+    }
+    return replace(set);
+}
+
+//An empty way leaves T1 or T2 without being remembered, it was not evicted for a new key
+void ARCPolicy::invalidate(int set, int way) {
+    unlink(set, way);
+}
+
+//Classify a missed key, adapting the T1 target on a ghost hit and keeping the ghost lists in bounds
+void ARCPolicy::admit(int set, uint64_t key) {
+    ArcSet& arc = arcSets[set];
+    int b1 = arc.ghosts[B1 - B1].size();
+    int b2 = arc.ghosts[B2 - B1].size();
+
+    arc.admittedFromB2 = false;
+    arc.t1Full = false;
+
+    auto ghost = arc.ghostIndex.find(key);
+    if (ghost != arc.ghostIndex.end()) {
+        //Seen before it was evicted, grow the side it was evicted from
+        if (ghost->second.first == B1) {
+            int step = (b2 / b1 > 1) ? b2 / b1 : 1;
+            arc.target = (arc.target + step < ways) ? arc.target + step : ways;
+        } else {
+            int step = (b1 / b2 > 1) ? b1 / b2 : 1;
+            arc.target = (arc.target - step > 0) ? arc.target - step : 0;
+            arc.admittedFromB2 = true;
+        }
+
+        arc.ghosts[ghost->second.first - B1].erase(ghost->second.second);
+        arc.ghostIndex.erase(ghost);
+        arc.admitTo = T2;
+        return;
+    }
+
+    //Never seen, it goes to T1 once the ghost lists are trimmed to make room
+    arc.admitTo = T1;
+    if (arc.size[T1] + b1 >= ways) {
+        if (arc.size[T1] < ways)
+            dropGhost(set, B1);
+        else
+            arc.t1Full = true;
+    } else if (arc.size[T1] + arc.size[T2] + b1 + b2 >= 2 * ways) {
+        dropGhost(set, B2);
+    }
+}
+
+//Evict the LRU way of T1 or T2 depending on the target, and remember its key in B1 or B2
+int ARCPolicy::replace(int set) {
+    ArcSet& arc = arcSets[set];
+
+    int list = T2;
+    if (arc.size[T1] > 0 && ((arc.admittedFromB2 && arc.size[T1] == arc.target) || arc.size[T1] > arc.target))
+        list = T1;
+    if (arc.size[T2] == 0)
+        list = T1;
+
+    int way = arc.lru[list];
+    unlink(set, way);
+
+    int ghostList = (list == T1) ? B1 : B2;
+    uint64_t key = keys[set * ways + way];
+    arc.ghosts[ghostList - B1].push_front(key);
+    arc.ghostIndex[key] = make_pair(ghostList, arc.ghosts[ghostList - B1].begin());
+    return way;
+}
+
+//Forget the oldest key of B1 or B2
+void ARCPolicy::dropGhost(int set, int list) {
+    ArcSet& arc = arcSets[set];
+    std::list<uint64_t>& ghosts = arc.ghosts[list - B1];
+    if (ghosts.empty())
+        return;
+
+    arc.ghostIndex.erase(ghosts.back());
+    ghosts.pop_back();
+}
+
+//Take a way out of T1 or T2
+void ARCPolicy::unlink(int set, int way) {
+    ArcSet& arc = arcSets[set];
+    int index = set * ways + way;
+    int list = listOf[index];
+
+    if (prev[index] != POLICY_NONE)
+        next[set * ways + prev[index]] = next[index];
+    else
+        arc.mru[list] = next[index];
+
+    if (next[index] != POLICY_NONE)
+        prev[set * ways + next[index]] = prev[index];
+    else
+        arc.lru[list] = prev[index];
+
+    prev[index] = POLICY_NONE;
+    next[index] = POLICY_NONE;
+    arc.size[list]--;
+}
+
+//Put a way at the most recently used end of T1 or T2
+void ARCPolicy::pushFront(int set, int way, int list) {
+    ArcSet& arc = arcSets[set];
+    int index = set * ways + way;
+
+    listOf[index] = list;
+    prev[index] = POLICY_NONE;
+    next[index] = arc.mru[list];
+
+    if (arc.mru[list] != POLICY_NONE)
+        prev[set * ways + arc.mru[list]] = way;
+    else
+        arc.lru[list] = way;
+
+    arc.mru[list] = way;
+    arc.size[list]++;
+}
@@ -0,0 +1,189 @@
+//This is the work of Teddy Barker
+
+#ifndef REPLACEMENTPOLICY_H
+#define REPLACEMENTPOLICY_H
+
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+
+//Marks the ends of a policy's lists and an unused way
+#define POLICY_NONE -1
+
+/**
+ * The replacement policies a TLB can use
+ */
+enum ReplacementPolicyType {
+    POLICY_LRU,
+    POLICY_CLOCK,
+    POLICY_PLRU,
+    POLICY_RANDOM,
+    POLICY_ARC
+};
+
+/*
+ * Replacement Policy class
+ *   Decides which way of a full set a TLB replaces. The TLB reports every
+ *   hit with touch, every newly filled way with fill and every way it
+ *   empties with invalidate, and asks for a victim only once all ways of
+ *   the set are in use. Entries are named
+ *   by a key that combines the VPN with the address space it belongs to.
+*/
+class ReplacementPolicy {
+    public:
+        virtual ~ReplacementPolicy() {}
+
+        //A lookup found the entry in this way
+        virtual void touch(int set, int way) = 0;
+
+        //The way now holds key, either an empty way or the last victim
+        virtual void fill(int set, int way, uint64_t key) = 0;
+
+        //Returns the way to replace in this full set to make room for key
+        virtual int victim(int set, uint64_t key) = 0;
+
+        //The way was emptied, it holds nothing until its next fill
+        virtual void invalidate(int set, int way) = 0;
+
+        static ReplacementPolicy* create(ReplacementPolicyType type, int sets, int ways);
+        static bool parse(const char* name, ReplacementPolicyType& type);
+};
+
+/*
+ * LRU Policy class
+ *   Exact least recently used, each set is an intrusive doubly-linked
+ *   list of its ways from most to least recently used.
+*/
+class LRUPolicy : public ReplacementPolicy {
+    public:
+        LRUPolicy(int sets, int ways);
+        ~LRUPolicy();
+
+        void touch(int set, int way);
+        void fill(int set, int way, uint64_t key);
+        int victim(int set, uint64_t key);
+        void invalidate(int set, int way);
+
+    private:
+        int ways;
+        int* prev;
+        int* next;
+        int* mru;
+        int* lru;
+
+        void unlink(int set, int way);
+        void pushFront(int set, int way);
+};
+
+/*
+ * CLOCK Policy class
+ *   Second chance replacement, a hand sweeps each set clearing
+ *   referenced bits and stops at the first way without one.
+*/
+class ClockPolicy : public ReplacementPolicy {
+    public:
+        ClockPolicy(int sets, int ways);
+        ~ClockPolicy();
+
+        void touch(int set, int way);
+        void fill(int set, int way, uint64_t key);
+        int victim(int set, uint64_t key);
+        void invalidate(int set, int way);
+
+    private:
+        int ways;
+        unsigned char* referenced;
+        int* hand;
+};
+
+/*
+ * Tree PLRU Policy class
+ *   Tree pseudo-LRU, a binary tree of bits per set where each bit points
+ *   at the half that was used less recently. Sets that are not a power
+ *   of 2 never follow a bit into the leaves past the last way.
+*/
+class TreePLRUPolicy : public ReplacementPolicy {
+    public:
+        TreePLRUPolicy(int sets, int ways);
+        ~TreePLRUPolicy();
+
+        void touch(int set, int way);
+        void fill(int set, int way, uint64_t key);
+        int victim(int set, uint64_t key);
+        void invalidate(int set, int way);
+
+    private:
+        int ways;
+        int leaves;
+        unsigned char* bits;
+};
+
+/*
+ * Random Policy class
+ *   Replaces a uniformly random way, from a fixed seed so runs repeat.
+*/
+class RandomPolicy : public ReplacementPolicy {
+    public:
+        RandomPolicy(int sets, int ways);
+
+        void touch(int set, int way);
+        void fill(int set, int way, uint64_t key);
+        int victim(int set, uint64_t key);
+        void invalidate(int set, int way);
+
+    private:
+        int ways;
+        uint64_t state;
+};
+
+/*
+ * ARC Policy class
+ *   Adaptive replacement cache. Each set keeps the ways seen once (T1)
+ *   apart from the ways seen again (T2), and remembers the keys recently
+ *   evicted from each (B1, B2). A miss on a remembered key moves the
+ *   target size of T1 towards the list it was evicted from.
+*/
+class ARCPolicy : public ReplacementPolicy {
+    public:
+        ARCPolicy(int sets, int ways);
+        ~ARCPolicy();
+
+        void touch(int set, int way);
+        void fill(int set, int way, uint64_t key);
+        int victim(int set, uint64_t key);
+        void invalidate(int set, int way);
+
+    private:
+        //Lists of a set, T1 and T2 link ways, B1 and B2 hold keys
+        enum { T1, T2, B1, B2 };
+
+        /**
+         * This Struct holds the lists of one set
+         */
+        struct ArcSet {
+            int mru[2]; //Most recently used way of T1 and T2
+            int lru[2]; //Least recently used way of T1 and T2
+            int size[2];
+            std::list<uint64_t> ghosts[2]; //B1 and B2, most recently evicted first
+            std::unordered_map<uint64_t, std::pair<int, std::list<uint64_t>::iterator> > ghostIndex;
+            int target; //Target size of T1
+            int admitTo; //List the key being admitted goes to, POLICY_NONE until it is classified
+            bool admittedFromB2; //The key being admitted was remembered in B2
+            bool t1Full; //T1 alone fills the set, so its LRU way is dropped without a ghost
+        };
+
+        int ways;
+        ArcSet* arcSets;
+        int* prev;
+        int* next;
+        unsigned char* listOf;
+        uint64_t* keys;
+
+        void admit(int set, uint64_t key);
+        int replace(int set);
+        void dropGhost(int set, int list);
+        void unlink(int set, int way);
+        void pushFront(int set, int way, int list);
+};
+
+#endif
@@ -0,0 +1,115 @@
+//This is the work of Teddy Barker
+
+#include "resultReader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+ResultReader::ResultReader() {
+    //Start with nothing mapped
+    mapping = nullptr;
+    mappingSize = 0;
+    recordCount = 0;
+}
+
+ResultReader::~ResultReader() {
+    close();
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Maps the result file at path into memory and checks its header.
+ * Returns false with the reason in error if it is not a complete result file
+ */
+bool ResultReader::open(const char* path, string& error) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        error = string("Unable to open <<") + path + ">>";
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (size_t) info.st_size < sizeof(ResultHeader)) {
+        ::close(fd);
+        error = string("<<") + path + ">> is not a result file";
+        return false;
+    }
+
+    mappingSize = info.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); //The mapping keeps its own reference to the file
+
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        mappingSize = 0;
+        error = string("Unable to map <<") + path + ">>";
+        return false;
+    }
+
+    //The records are read front to back
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+    const ResultHeader& header = getHeader();
+    if (header.magic == __builtin_bswap32(RESULT_MAGIC)) {
+        error = string("<<") + path + ">> was written on a machine of the other byte order";
+    } else if (header.magic != RESULT_MAGIC) {
+        error = string("<<") + path + ">> is not a result file";
+    } else if (header.version != RESULT_VERSION || header.recordSize != sizeof(ResultRecord)) {
+        error = string("<<") + path + ">> is from another version of the simulator";
+    } else if (header.levelCount == 0 || header.levelCount > MAX_LEVELS) {
+        error = string("<<") + path + ">> has a damaged header";
+    } else if (mappingSize - sizeof(ResultHeader) != header.recordCount * sizeof(ResultRecord)) {
+        //The count is only written once the run is over, so a run that did not finish leaves it at 0
+        error = string("<<") + path + ">> does not hold the records its header counts, the run may not have finished";
+    } else {
+        recordCount = header.recordCount;
+        return true;
+    }
+
+    close();
+    return false;
+}
+
+/**
+ * Unmaps the result file, if one is mapped
+ */
+void ResultReader::close() {
+    if (mapping != nullptr)
+        munmap(mapping, mappingSize);
+
+    mapping = nullptr;
+    mappingSize = 0;
+    recordCount = 0;
+}
+
+/**
+ * Getter for the header, the configuration the results were made with
+ */
+const ResultHeader& ResultReader::getHeader() {
+    return *(const ResultHeader*) mapping;
+}
+
+/**
+ * Getter for the records, they stay valid until the reader is closed
+ */
+const ResultRecord* ResultReader::getRecords() {
+    return (const ResultRecord*) ((const char*) mapping + sizeof(ResultHeader));
+}
+
+/**
+ * Getter for the number of records in the file
+ */
+size_t ResultReader::getRecordCount() {
+    return recordCount;
+}
@@ -0,0 +1,40 @@
+//This is the work of Teddy Barker
+
+#ifndef RESULTREADER_H
+#define RESULTREADER_H
+
+#include <stddef.h>
+#include <string>
+#include "resultWriter.h"
+
+/*
+ * Result Reader class
+ *   A memory mapping of a result file written by ResultWriter. The
+ *   header is checked when the file is opened and the records are read
+ *   in place, so a tool can walk millions of translations without
+ *   parsing any text. A file written on a machine of the other byte
+ *   order, or cut short, is rejected.
+*/
+class ResultReader {
+    public:
+        ResultReader();
+        ~ResultReader();
+
+        //The reader owns its mapping, so it can not be copied
+        ResultReader(const ResultReader&) = delete;
+        ResultReader& operator=(const ResultReader&) = delete;
+
+        bool open(const char* path, std::string& error);
+        void close();
+
+        const ResultHeader& getHeader();
+        const ResultRecord* getRecords();
+        size_t getRecordCount();
+
+    private:
+        void* mapping;
+        size_t mappingSize;
+        size_t recordCount;
+};
+
+#endif
@@ -0,0 +1,92 @@
+//This is the work of Teddy Barker
+
+#include "resultWriter.h"
+
+#include <cstring>
+
+using namespace std;
+
+//Readers rely on the layout, so it can not change without a new version
+static_assert(sizeof(ResultRecord) == 24, "ResultRecord must be 24 bytes");
+static_assert(sizeof(ResultHeader) == 56 + MAX_LEVELS, "ResultHeader must have no padding");
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+ResultWriter::ResultWriter() {
+    file = nullptr;
+    buffer = new ResultRecord[RESULT_BUFFER_RECORDS];
+    buffered = 0;
+    failed = false;
+    memset(&header, 0, sizeof(header));
+}
+
+ResultWriter::~ResultWriter() {
+    close();
+    delete[] buffer;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Creates the result file at path and writes the header of this configuration,
+ * levels of entryCount entries each. Returns false if the file can not be written
+ */
+bool ResultWriter::open(const char* path, unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config) {
+    close();
+
+    file = fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = RESULT_MAGIC;
+    header.version = RESULT_VERSION;
+    header.recordSize = sizeof(ResultRecord);
+    header.levelCount = levelCount;
+    header.addressBits = config.addressBits;
+    header.backend = config.pageTableBackend;
+    header.tlbSize = config.tlbSize;
+    header.tlbWays = config.tlbWays;
+    header.itlbSize = config.itlbSize;
+    header.dtlbSize = config.dtlbSize;
+    header.tlbPolicy = config.tlbPolicy;
+    header.frameLimit = config.frameLimit;
+    header.hugePageDepth = config.hugePageDepth;
+    for (unsigned int i = 0; i < levelCount; i++) {
+        header.levelBits[i] = __builtin_ctz(entryCount[i]);
+    }
+
+    //The record count is filled in by close, once it is known
+    buffered = 0;
+    failed = fwrite(&header, sizeof(header), 1, file) != 1;
+    return !failed;
+}
+
+/**
+ * Writes the buffered records to the file
+ */
+void ResultWriter::flush() {
+    if (buffered > 0 && fwrite(buffer, sizeof(ResultRecord), buffered, file) != buffered)
+        failed = true;
+    header.recordCount += buffered;
+    buffered = 0;
+}
+
+/**
+ * Writes the last records and the final record count, then closes the file.
+ * Returns false if any of it could not be written
+ */
+bool ResultWriter::close() {
+    if (file == nullptr)
+        return true;
+
+    flush();
+    if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file) != 1)
+        failed = true;
+    if (fclose(file) != 0)
+        failed = true;
+    file = nullptr;
+    return !failed;
+}
@@ -0,0 +1,118 @@
+//This is the work of Teddy Barker
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "tlbHierarchy.h"
+#include "pageWalk.h"
+
+//First bytes of a result file, "PWR1" in the byte order of the machine that wrote it
+#define RESULT_MAGIC 0x31525750
+#define RESULT_VERSION 1
+
+//Records gathered before the writer hands them to the file
+#define RESULT_BUFFER_RECORDS (1 << 16)
+
+//Bits of ResultRecord.flags
+#define RESULT_TLB_HIT 0x1
+#define RESULT_PAGE_TABLE_HIT 0x2
+#define RESULT_HUGE_PAGE 0x4
+
+/**
+ * This Struct is the header at the start of a result file, the
+ * configuration the translations were made with:
+ *  - the magic number, version and size of a record, for the reader to check
+ *  - the page table levels, address width and backend
+ *  - the TLB hierarchy, its policy and the frame limit and huge page depth, 0 for none
+ *  - the number of records that follow, filled in once the run is over
+ *  - the bits of each page table level, the first levelCount are used
+ */
+struct ResultHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t levelCount;
+    uint32_t addressBits;
+    uint32_t backend;
+    uint32_t tlbSize;
+    uint32_t tlbWays;
+    uint32_t itlbSize;
+    uint32_t dtlbSize;
+    uint32_t tlbPolicy;
+    uint32_t frameLimit;
+    uint32_t hugePageDepth;
+    uint64_t recordCount;
+    uint8_t levelBits[MAX_LEVELS];
+};
+
+/**
+ * This Struct is the result of one translation, 24 bytes:
+ *  - the virtual and physical address
+ *  - the time, reqtype and proc of its trace record
+ *  - the RESULT_ flags of its TLB and page table hits and page size
+ *  - the TLB level that hit, 1 for an L1 TLB, 2 for the unified TLB, 0 for a miss
+ */
+struct ResultRecord {
+    uint64_t vAddr;
+    uint64_t pAddr;
+    uint32_t time;
+    uint8_t reqtype;
+    uint8_t proc;
+    uint8_t flags;
+    uint8_t tlbLevel;
+};
+
+/*
+ * Result Writer class
+ *   Writes the translations of a run to a file as fixed width binary
+ *   records after a header describing the configuration, for tools that
+ *   would otherwise parse the text of va2pa_atc_ptwalk. Records are
+ *   gathered in a buffer and written a batch at a time. Everything is in
+ *   the byte order of the machine that wrote it, ResultReader reads it.
+*/
+class ResultWriter {
+    public:
+        ResultWriter();
+        ~ResultWriter();
+
+        //The writer owns its file and buffer, so it can not be copied
+        ResultWriter(const ResultWriter&) = delete;
+        ResultWriter& operator=(const ResultWriter&) = delete;
+
+        bool open(const char* path, unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config);
+        void write(const Translation& translation, unsigned char reqtype, unsigned char proc, uint32_t time);
+        bool close();
+
+    private:
+        FILE* file;
+        ResultHeader header;
+        ResultRecord* buffer;
+        size_t buffered;
+        bool failed; //A write went wrong, close reports it
+
+        void flush();
+};
+
+/**
+ * Adds the result of one translation, made for a trace record with this
+ * reqtype, proc and time. Defined here so that the translate loop can inline it
+ */
+inline void ResultWriter::write(const Translation& translation, unsigned char reqtype, unsigned char proc, uint32_t time) {
+    ResultRecord& record = buffer[buffered];
+    record.vAddr = translation.vAddr;
+    record.pAddr = translation.pAddr;
+    record.time = time;
+    record.reqtype = reqtype;
+    record.proc = proc;
+    record.flags = (translation.tlbHit ? RESULT_TLB_HIT : 0) |
+                   (translation.pageTableHit ? RESULT_PAGE_TABLE_HIT : 0) |
+                   (translation.hugePage ? RESULT_HUGE_PAGE : 0);
+    record.tlbLevel = translation.tlbLevel;
+
+    if (++buffered == RESULT_BUFFER_RECORDS)
+        flush();
+}
+
+#endif
@@ -0,0 +1,163 @@
+//This is the work of Teddy Barker
+
+#include "sampler.h"
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+Sampler::Sampler(size_t period, size_t unit, size_t warmup) {
+    this->period = period;
+    this->unit = unit;
+    this->warmup = warmup;
+
+    unitOpen = false;
+    startAccesses = 0;
+    startTlbHits = 0;
+
+    units = 0;
+    sum = 0;
+    squareSum = 0;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Returns the phase of this record, with end set to the first record after its phase.
+ * A unit is closed at the start of the next period and opened at its own first record
+ */
+SamplePhase Sampler::next(size_t record, size_t& end, Simulator& simulator) {
+    size_t position = record % period;
+    size_t periodStart = record - position;
+    size_t measureStart = period - unit;
+    size_t warmupStart = measureStart - warmup;
+
+    if (position == 0 && unitOpen)
+        closeUnit(simulator);
+
+    if (position < warmupStart) {
+        end = periodStart + warmupStart;
+        return SAMPLE_FUNCTIONAL;
+    }
+    if (position < measureStart) {
+        end = periodStart + measureStart;
+        return SAMPLE_WARMUP;
+    }
+
+    if (position == measureStart) {
+        unitOpen = true;
+        startAccesses = simulator.getAccessCount();
+        startTlbHits = simulator.getTlbHits();
+    }
+    end = periodStart + period;
+    return SAMPLE_MEASURE;
+}
+
+/**
+ * Closes the last unit once the trace is over, if it ran to the end of its period
+ */
+void Sampler::finish(size_t record, Simulator& simulator) {
+    if (unitOpen && record % period == 0)
+        closeUnit(simulator);
+    unitOpen = false;
+}
+
+/**
+ * Adds the hit rate of the open unit, from the counts the simulator gained since it began
+ */
+void Sampler::closeUnit(Simulator& simulator) {
+    double rate = (double) (simulator.getTlbHits() - startTlbHits) / (double) (simulator.getAccessCount() - startAccesses);
+    sum += rate;
+    squareSum += rate * rate;
+    units++;
+    unitOpen = false;
+}
+
+/**
+ * Returns the estimate of the TLB hit rate of a trace of this many records. Every unit has
+ * the same number of records, so the mean of their rates is the rate of all of them. The
+ * interval shrinks by the share of the trace that was measured, as the units are drawn
+ * from a finite number of them
+ */
+SampleEstimate Sampler::getEstimate(size_t records) {
+    SampleEstimate estimate;
+    estimate.mean = units ? sum / units : 0.0;
+    estimate.halfWidth = -1.0;
+    if (units < 2)
+        return estimate;
+
+    double variance = (squareSum - units * estimate.mean * estimate.mean) / (units - 1);
+    if (variance < 0)
+        variance = 0; //Rounding, when every unit has the same rate
+
+    double population = (double) (records / unit);
+    double correction = (population > units) ? 1.0 - units / population : 0.0;
+    estimate.halfWidth = SAMPLE_CONFIDENCE_Z * sqrt(variance / units * correction);
+    return estimate;
+}
+
+/**
+ * Getter for the number of units measured
+ */
+unsigned long Sampler::getUnits() {
+    return units;
+}
+
+/**
+ * Getter for the records in a unit
+ */
+size_t Sampler::getUnitSize() {
+    return unit;
+}
+
+/**
+ * Getter for the records in a period
+ */
+size_t Sampler::getPeriod() {
+    return period;
+}
+
+/**
+ * Reads <period>[:<unit>[:<warmup>]] from the command line, every one a number of records.
+ * The unit and warmup must fit in the period and the unit must be at least one record.
+ * A unit or warmup that is not given is a hundredth of the period, at least MIN_SAMPLE_UNIT
+ * records, cut down to what is left of the period. Returns false if the text is not valid
+ */
+bool Sampler::parse(const char* text, size_t& period, size_t& unit, size_t& warmup) {
+    char* end;
+    long long value = strtoll(text, &end, 10);
+    if (end == text || value <= 0)
+        return false;
+    period = value;
+
+    size_t share = max(period / DEFAULT_SAMPLE_FRACTION, (size_t) MIN_SAMPLE_UNIT);
+    unit = max(min(share, period / 2), (size_t) 1);
+    bool warmupGiven = false;
+
+    if (*end == ':') {
+        text = end + 1;
+        value = strtoll(text, &end, 10);
+        if (end == text || value <= 0)
+            return false;
+        unit = value;
+
+        if (*end == ':') {
+            text = end + 1;
+            value = strtoll(text, &end, 10);
+            if (end == text || value < 0)
+                return false;
+            warmup = value;
+            warmupGiven = true;
+        }
+    }
+
+    //A unit too long for the period is an error below, so it leaves no room to warm up in
+    if (!warmupGiven)
+        warmup = (unit < period) ? min(share, period - unit) : 0;
+    return *end == '\0' && unit + warmup <= period;
+}
@@ -0,0 +1,87 @@
+//This is the work of Teddy Barker
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stddef.h>
+#include "simulator.h"
+
+//Records measured in each sample and simulated in detail before it when -S does not give them,
+//each a hundredth of the period but at least MIN_SAMPLE_UNIT records, as far as the period has room
+#define DEFAULT_SAMPLE_FRACTION 100
+#define MIN_SAMPLE_UNIT 100
+
+//Normal quantile of the two sided 95% confidence intervals reported
+#define SAMPLE_CONFIDENCE_Z 1.96
+
+/**
+ * The parts of every sampling period, in the order they come:
+ *  - functional warming, the page table and TLBs are kept up to date without counting
+ *  - detailed warming, every record is translated but the counts are not used
+ *  - the sample unit, whose counts are measured
+ */
+enum SamplePhase {
+    SAMPLE_FUNCTIONAL,
+    SAMPLE_WARMUP,
+    SAMPLE_MEASURE
+};
+
+/**
+ * This Struct holds the estimate of the TLB hit rate of the whole trace, as
+ * a fraction of the addresses, and the half width of its confidence interval,
+ * negative when there are too few units to give one
+ */
+struct SampleEstimate {
+    double mean;
+    double halfWidth;
+};
+
+/*
+ * Sampler class
+ *   Systematic sampling of a trace, in the style of SMARTS. The trace is
+ *   cut into periods of the same number of records, and the last unit
+ *   records of each are a sample unit, measured in detail. The warmup
+ *   records before a unit are also translated in detail, to warm the walk
+ *   cache. Everything before that is functional warming, Simulator::warm
+ *   keeps the page table and the TLB entries and replacement state up to
+ *   date without counting, so a unit starts from the TLBs a full run
+ *   would have.
+ *
+ *   The TLB hit rate of every unit is kept, and their mean estimates the
+ *   rate of the whole trace with a confidence interval from their
+ *   variance. A unit cut short by the end of the trace is not counted.
+ *   Page faults need no estimate, functional warming counts every one.
+*/
+class Sampler {
+    public:
+        Sampler(size_t period, size_t unit, size_t warmup);
+
+        SamplePhase next(size_t record, size_t& end, Simulator& simulator);
+        void finish(size_t record, Simulator& simulator);
+
+        unsigned long getUnits();
+        size_t getUnitSize();
+        size_t getPeriod();
+        SampleEstimate getEstimate(size_t records);
+
+        static bool parse(const char* text, size_t& period, size_t& unit, size_t& warmup);
+
+    private:
+        size_t period;
+        size_t unit;
+        size_t warmup;
+
+        //The counts of the simulator when the open unit began
+        bool unitOpen;
+        unsigned long startAccesses;
+        unsigned long startTlbHits;
+
+        //Sums of the hit rates of the units and of their squares
+        unsigned long units;
+        double sum;
+        double squareSum;
+
+        void closeUnit(Simulator& simulator);
+};
+
+#endif
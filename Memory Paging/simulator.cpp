@@ -0,0 +1,341 @@
+//This is the work of Teddy Barker
+
+#include "simulator.h"
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+Simulator::Simulator(unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config)
+    : tlbs(config) {
+    //Build the page table on the selected backend and pick its walk, specialized on this level count
+    pageTable = PageTable::create(config.pageTableBackend, levelCount, entryCount, config.addressBits);
+    this->levelCount = levelCount;
+    walkCache = nullptr;
+    if (!config.walkCacheSizes.empty()) {
+        walkCache = new PageWalkCache(pageTable, config.walkCacheSizes);
+    }
+
+    //Huge pages are levels of the radix tree, the walker picks them up from the page table
+    hugePageFrames = 0;
+    if (config.hugePageDepth > 0) {
+        LevelPageTable* levelPageTable = (LevelPageTable*) pageTable;
+        levelPageTable->enableHugePages(config.hugePageDepth, config.hugePageThreshold);
+        hugePageFrames = levelPageTable->getHugePageFrames();
+        tlbs.enableHugePages(__builtin_ctz(hugePageFrames));
+    }
+    pageWalk = PageWalk::create(pageTable, walkCache);
+
+    //Bounded physical memory, the page table takes its frames from the frame table
+    frameTable = nullptr;
+    if (config.frameLimit > 0) {
+        frameTable = new FrameTable(config.frameLimit, config.evictionPolicy, config.workingSetWindow);
+        pageTable->setFrameTable(frameTable);
+    }
+
+    lastVpn = TLB_INVALID_TAG;
+    lastFetch = false;
+    lastPfn = 0;
+    lastTlbLevel = 0;
+    lastHugePage = false;
+    splitSides = tlbs.hasL1Tlbs();
+
+    accessCount = 0;
+    tlbHits = 0;
+    pageTableHits = 0;
+    hugePageAccesses = 0;
+    hugePageTlbHits = 0;
+
+    warmVpns = new uint64_t[WARM_FILTER_ENTRIES];
+    warmPfns = new unsigned int[WARM_FILTER_ENTRIES];
+    warmHugePages = new bool[WARM_FILTER_ENTRIES];
+    warmFaults = 0;
+    for (unsigned int i = 0; i < WARM_FILTER_ENTRIES; i++) {
+        warmVpns[i] = TLB_INVALID_TAG;
+    }
+}
+
+Simulator::~Simulator() {
+    delete[] warmVpns;
+    delete[] warmPfns;
+    delete[] warmHugePages;
+    delete pageWalk;
+    delete walkCache;
+    delete pageTable;
+    delete frameTable;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Translates one virtual address, checking the TLBs from L1 down before walking the page table.
+ * Instruction fetches go to the L1 instruction TLB and everything else to the L1 data TLB.
+ * The time is the record's time since the one before it, which only bounded memory uses
+ */
+void Simulator::translate(uint64_t vAddr, unsigned char reqtype, uint32_t time, Translation& result) {
+    //Split the address into its page indices, VPN and offset
+    pageWalk->decompose(vAddr, result);
+    translateDecomposed(reqtype, time, result, nullptr, 0);
+}
+
+/**
+ * Translates one virtual address already split by PageTable::decomposeBatch, its page
+ * index on level l at pageIndices[l * levelStride]. The indices are only copied into
+ * the result for a walk, so after a TLB hit they are not set
+ */
+void Simulator::translate(uint64_t vAddr, uint64_t vpn, uint64_t offset, const unsigned int* pageIndices,
+                          size_t levelStride, unsigned char reqtype, uint32_t time, Translation& result) {
+    result.vAddr = vAddr;
+    result.vpn = vpn;
+    result.offset = offset;
+    translateDecomposed(reqtype, time, result, pageIndices, levelStride);
+}
+
+/**
+ * The translation of a decomposed address, with the page indices still to copy for a walk
+ * when pageIndices is not nullptr
+ */
+void Simulator::translateDecomposed(unsigned char reqtype, uint32_t time, Translation& result,
+                                    const unsigned int* pageIndices, size_t levelStride) {
+    if (frameTable != nullptr)
+        frameTable->advance(time);
+
+    result.pageTableHit = false;
+    result.promoted = false;
+
+    //The same page as the last TLB hit is a hit in the same entry again
+    if (canRepeat(result.vpn, reqtype)) {
+        result.tlbHit = true;
+        result.tlbLevel = lastTlbLevel;
+        result.hugePage = lastHugePage;
+        result.pfn = lastPfn;
+        repeat(reqtype, 1, 0);
+        result.pAddr = ((uint64_t) result.pfn << pageTable->getShiftAry()[pageTable->getLevelCount() - 1]) | result.offset;
+        return;
+    }
+    result.hugePage = false;
+
+    //Check the TLBs, every entry belongs to the one address space 0
+    int pfn = tlbs.lookup(result.vpn, reqtype, 0, result.tlbLevel, result.hugePage);
+    result.tlbHit = (pfn != -1);
+
+    if (result.tlbHit) {
+        result.pfn = pfn;
+        tlbHits++;
+    } else {
+        if (pageIndices != nullptr) {
+            for (unsigned int level = 0; level < levelCount; level++)
+                result.pageIndices[level] = pageIndices[level * levelStride];
+        }
+
+        //If not found in any TLB, walk the page table
+        pageWalk->walk(result);
+        if (result.pageTableHit) {
+            pageTableHits++;
+        }
+
+        //A new huge page replaces the small pages of its range, so their entries are shot down, warmed ones too
+        if (result.promoted) {
+            uint64_t firstVpn = result.vpn & ~(uint64_t) (hugePageFrames - 1);
+            for (unsigned int page = 0; page < hugePageFrames; page++) {
+                shootDown(firstVpn + page);
+            }
+        }
+
+        //The page evicted to make room for a new one is no longer mapped, so its entries are shot down
+        uint64_t evictedVpn;
+        if (frameTable != nullptr && frameTable->takeEviction(evictedVpn)) {
+            shootDown(evictedVpn);
+        }
+
+        //Insert into every TLB on the way back
+        tlbs.insert(result.vpn, result.pfn, reqtype, 0, result.hugePage);
+    }
+
+    if (frameTable != nullptr)
+        frameTable->touch(result.pfn);
+
+    if (result.hugePage) {
+        hugePageAccesses++;
+        if (result.tlbHit)
+            hugePageTlbHits++;
+    }
+
+    //Keep a hit in the first TLB of its side for the accesses to the same page that follow
+    lastVpn = TLB_INVALID_TAG;
+    if (result.tlbHit && tlbs.isFirstLevel(reqtype, result.tlbLevel)) {
+        lastVpn = result.vpn;
+        lastFetch = (reqtype == FETCH);
+        lastPfn = result.pfn;
+        lastTlbLevel = result.tlbLevel;
+        lastHugePage = result.hugePage;
+    }
+
+    //Build the physical address from the frame and the offset
+    result.pAddr = ((uint64_t) result.pfn << pageTable->getShiftAry()[pageTable->getLevelCount() - 1]) | result.offset;
+
+    accessCount++;
+}
+
+/**
+ * Counts count more accesses of this kind to the page of the last translation, which
+ * canRepeat must allow, elapsed being the sum of their times. Each is a hit in the TLB
+ * entry the last one hit, so none of them probes the TLBs
+ */
+void Simulator::repeat(unsigned char reqtype, unsigned long count, uint64_t elapsed) {
+    tlbs.countRepeatHits(reqtype, lastTlbLevel, count);
+    tlbHits += count;
+    accessCount += count;
+
+    //Nothing is evicted on a hit, so only the frame's last use matters
+    if (frameTable != nullptr) {
+        frameTable->advance(elapsed);
+        frameTable->touch(lastPfn);
+    }
+
+    if (lastHugePage) {
+        hugePageAccesses += count;
+        hugePageTlbHits += count;
+    }
+}
+
+/**
+ * Walks the page table for the page of this access during functional warming, keeping the
+ * page, its frame and whether it is in a huge page in this entry of the filter. Nothing is
+ * counted, but the entries of a page that was promoted or evicted are still shot down
+ */
+void Simulator::warmPage(uint64_t vAddr, unsigned int entry) {
+    Translation result;
+    pageWalk->decompose(vAddr, result);
+    result.pageTableHit = false;
+    result.promoted = false;
+    result.hugePage = false;
+    pageWalk->walk(result);
+    if (!result.pageTableHit) {
+        warmFaults++;
+    }
+
+    if (result.promoted) {
+        uint64_t firstVpn = result.vpn & ~(uint64_t) (hugePageFrames - 1);
+        for (unsigned int page = 0; page < hugePageFrames; page++) {
+            shootDown(firstVpn + page);
+        }
+    }
+
+    uint64_t evictedVpn;
+    if (frameTable != nullptr && frameTable->takeEviction(evictedVpn)) {
+        shootDown(evictedVpn);
+    }
+
+    //A shoot down may have taken the entry of the last TLB hit
+    lastVpn = TLB_INVALID_TAG;
+
+    warmVpns[entry] = result.vpn;
+    warmPfns[entry] = result.pfn;
+    warmHugePages[entry] = result.hugePage;
+}
+
+/**
+ * Removes an evicted page, or a small page taken into a huge page, from every TLB and
+ * from the filter of warmed pages
+ */
+void Simulator::shootDown(uint64_t vpn) {
+    tlbs.invalidate(vpn, 0);
+
+    unsigned int entry = warmEntry(vpn);
+    if (warmVpns[entry] == vpn)
+        warmVpns[entry] = TLB_INVALID_TAG;
+}
+
+/**
+ * Getter for the number of addresses translated through a huge page
+ */
+unsigned long Simulator::getHugePageAccesses() {
+    return hugePageAccesses;
+}
+
+/**
+ * Getter for the number of those found in the TLB
+ */
+unsigned long Simulator::getHugePageTlbHits() {
+    return hugePageTlbHits;
+}
+
+/**
+ * Getter for the page table
+ */
+PageTable* Simulator::getPageTable() {
+    return pageTable;
+}
+
+/**
+ * Getter for the page walk cache, nullptr if there is none
+ */
+PageWalkCache* Simulator::getWalkCache() {
+    return walkCache;
+}
+
+/**
+ * Getter for the frame table of bounded physical memory, nullptr if memory is endless
+ */
+FrameTable* Simulator::getFrameTable() {
+    return frameTable;
+}
+
+/**
+ * Getter for the number of addresses translated
+ */
+unsigned long Simulator::getAccessCount() {
+    return accessCount;
+}
+
+/**
+ * Getter for the number of translations found in the TLB
+ */
+unsigned long Simulator::getTlbHits() {
+    return tlbHits;
+}
+
+/**
+ * Getter for the number of translations found in the page table
+ */
+unsigned long Simulator::getPageTableHits() {
+    return pageTableHits;
+}
+
+/**
+ * Getter for the number of page faults taken by functional warming, they are not counted as misses
+ */
+unsigned long Simulator::getWarmFaults() {
+    return warmFaults;
+}
+
+/**
+ * Returns true if there is an L1 instruction or data TLB in front of the unified TLB
+ */
+bool Simulator::hasL1Tlbs() {
+    return tlbs.hasL1Tlbs();
+}
+
+/**
+ * Getter for the L1 instruction TLB counts
+ */
+TLBLevelStats Simulator::getItlbStats() {
+    return tlbs.getItlbStats();
+}
+
+/**
+ * Getter for the L1 data TLB counts
+ */
+TLBLevelStats Simulator::getDtlbStats() {
+    return tlbs.getDtlbStats();
+}
+
+/**
+ * Getter for the unified TLB counts
+ */
+TLBLevelStats Simulator::getTlbStats() {
+    return tlbs.getTlbStats();
+}
@@ -0,0 +1,162 @@
+//This is the work of Teddy Barker
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "pageTable.h"
+#include "tlbHierarchy.h"
+#include "pageWalk.h"
+#include "pageWalkCache.h"
+#include "tracereader.h"
+
+//Pages remembered by functional warming, so a page warmed before is not walked again
+#define WARM_FILTER_BITS 14
+#define WARM_FILTER_ENTRIES (1 << WARM_FILTER_BITS)
+
+/*
+ * Simulator class
+ *   Owns a page table and an optional TLB hierarchy, L1 instruction and
+ *   data TLBs in front of a unified TLB, with an optional page walk cache
+ *   for the walks that miss every TLB and optional huge pages, and translates addresses
+ *   through them one at a time, keeping the hit counts as it goes.
+ *   An address may come already split by PageTable::decomposeBatch, then
+ *   its page indices are only read when it misses every TLB.
+ *   With a frame limit it also owns the frame table of physical memory,
+ *   moving its clock by each record's time and shooting down the TLB
+ *   entries of every page it evicts.
+ *
+ *   The last translation that hit the first TLB its access probes is kept
+ *   ahead of the hierarchy. Another access to that page from the same
+ *   side is a hit in the same entry, and touching the entry it just
+ *   touched leaves every replacement policy as it was, so it is counted
+ *   without probing. repeat counts a whole run of such accesses at once.
+ *   With a single address space every TLB entry is tagged ASID 0.
+ *
+ *   warm is the functional warming of a sampled run, it maps the page of
+ *   an access and updates the TLB entries and replacement state as a
+ *   translation would, without counting anything but the page faults, so
+ *   they stay exact. A direct mapped filter, hashed like the hashed page
+ *   table, holds the pages it mapped with their frames, and as a page only
+ *   leaves the page table when it is evicted or becomes part of a huge
+ *   page, a page found there is not walked again.
+ *   It does not know where the addresses come from, so every trace
+ *   source in main.cpp can drive the same translation path.
+*/
+class Simulator {
+    public:
+        Simulator(unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config);
+        ~Simulator();
+
+        void translate(uint64_t vAddr, unsigned char reqtype, uint32_t time, Translation& result);
+        void translate(uint64_t vAddr, uint64_t vpn, uint64_t offset, const unsigned int* pageIndices,
+                       size_t levelStride, unsigned char reqtype, uint32_t time, Translation& result);
+        bool canRepeat(uint64_t vpn, unsigned char reqtype);
+        void repeat(unsigned char reqtype, unsigned long count, uint64_t elapsed);
+        void warm(uint64_t vAddr, uint64_t vpn, unsigned char reqtype, uint32_t time);
+
+        PageTable* getPageTable();
+        PageWalkCache* getWalkCache();
+        FrameTable* getFrameTable();
+        unsigned long getAccessCount();
+        unsigned long getTlbHits();
+        unsigned long getPageTableHits();
+        unsigned long getWarmFaults();
+        bool hasL1Tlbs();
+        TLBLevelStats getItlbStats();
+        TLBLevelStats getDtlbStats();
+        TLBLevelStats getTlbStats();
+        unsigned long getHugePageAccesses();
+        unsigned long getHugePageTlbHits();
+
+    private:
+        PageTable* pageTable;
+        unsigned int levelCount;
+        PageWalk* pageWalk;
+        PageWalkCache* walkCache;
+        FrameTable* frameTable;
+        TLBHierarchy tlbs;
+
+        unsigned long accessCount;
+        unsigned long tlbHits;
+        unsigned long pageTableHits;
+
+        //The last translation, while it was a hit in the first TLB its side probes
+        uint64_t lastVpn; //TLB_INVALID_TAG when there is none
+        bool lastFetch;
+        unsigned int lastPfn;
+        unsigned char lastTlbLevel;
+        bool lastHugePage;
+        bool splitSides; //Fetches and data go to different L1 TLBs
+
+        unsigned int hugePageFrames; //Small pages in a huge page, 0 without huge pages
+        unsigned long hugePageAccesses;
+        unsigned long hugePageTlbHits;
+
+        //Functional warming, the pages warmed and their frames, TLB_INVALID_TAG for an empty entry
+        uint64_t* warmVpns;
+        unsigned int* warmPfns;
+        bool* warmHugePages;
+        unsigned long warmFaults;
+
+        static unsigned int warmEntry(uint64_t vpn);
+
+        void translateDecomposed(unsigned char reqtype, uint32_t time, Translation& result,
+                                 const unsigned int* pageIndices, size_t levelStride);
+
+        void warmPage(uint64_t vAddr, unsigned int entry);
+        void shootDown(uint64_t vpn);
+};
+
+/**
+ * Returns true if an access of this kind to vpn would hit the entry the last
+ * translation hit. Defined here so that the run loops can inline it
+ */
+inline bool Simulator::canRepeat(uint64_t vpn, unsigned char reqtype) {
+    return vpn == lastVpn && (!splitSides || (reqtype == FETCH) == lastFetch);
+}
+
+/**
+ * Returns the entry of the filter of warmed pages that vpn goes in
+ */
+inline unsigned int Simulator::warmEntry(uint64_t vpn) {
+    return (vpn * 0x9E3779B97F4A7C15ull) >> (64 - WARM_FILTER_BITS);
+}
+
+/**
+ * Maps the page of this access for functional warming, walking the page table only if
+ * the page is not in the filter, and warms the TLBs with its translation. Defined here
+ * so that the sampling loop can inline it
+ */
+inline void Simulator::warm(uint64_t vAddr, uint64_t vpn, unsigned char reqtype, uint32_t time) {
+    if (frameTable != nullptr)
+        frameTable->advance(time);
+
+    //The same page as the last TLB hit would hit the same entry again, which changes nothing
+    if (canRepeat(vpn, reqtype)) {
+        if (frameTable != nullptr)
+            frameTable->touch(lastPfn);
+        return;
+    }
+
+    unsigned int entry = warmEntry(vpn);
+    if (warmVpns[entry] != vpn)
+        warmPage(vAddr, entry);
+
+    //Keep a hit in the first TLB of its side, as translate does, for the accesses to the same page that follow
+    unsigned char level;
+    bool hugePage = warmHugePages[entry];
+    int pfn = tlbs.warm(vpn, warmPfns[entry], reqtype, 0, level, hugePage);
+    lastVpn = TLB_INVALID_TAG;
+    if (level != 0 && tlbs.isFirstLevel(reqtype, level)) {
+        lastVpn = vpn;
+        lastFetch = (reqtype == FETCH);
+        lastPfn = pfn;
+        lastTlbLevel = level;
+        lastHugePage = hugePage;
+    }
+
+    if (frameTable != nullptr)
+        frameTable->touch(pfn);
+}
+
+#endif
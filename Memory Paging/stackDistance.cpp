@@ -0,0 +1,115 @@
+//This is the work of Teddy Barker
+
+#include "stackDistance.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//Times in the Fenwick tree before the first compaction
+#define INITIAL_TIMES (1 << 16)
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+StackDistance::StackDistance(unsigned int maxDistance) {
+    this->maxDistance = maxDistance;
+    distanceCounts.assign(maxDistance + 1, 0);
+    accessCount = 0;
+
+    tree.assign(INITIAL_TIMES + 1, 0);
+    now = 0;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Records an access to a page, counting its stack distance if it was seen before
+ */
+void StackDistance::access(uint64_t vpn) {
+    if (now + 1 == tree.size())
+        compact();
+    now++;
+    accessCount++;
+
+    auto last = lastAccess.find(vpn);
+    if (last != lastAccess.end()) {
+        //Distinct pages since the last access, counting this one
+        unsigned long distance = marksUpTo(now - 1) - marksUpTo(last->second) + 1;
+        if (distance <= maxDistance)
+            distanceCounts[distance]++;
+
+        //Only the latest access of a page keeps a mark
+        add(last->second, -1);
+        last->second = now;
+    } else {
+        //First access, a miss at every capacity
+        lastAccess[vpn] = now;
+    }
+
+    add(now, 1);
+}
+
+/**
+ * Getter for the number of accesses recorded
+ */
+unsigned long StackDistance::getAccessCount() {
+    return accessCount;
+}
+
+/**
+ * Fills hits[c] with the hits a fully associative LRU TLB of capacity c would
+ * have had, for every capacity up to the largest distance counted
+ */
+void StackDistance::getHitCurve(unsigned long* hits) {
+    hits[0] = 0;
+    for (unsigned int capacity = 1; capacity <= maxDistance; capacity++)
+        hits[capacity] = hits[capacity - 1] + distanceCounts[capacity];
+}
+
+/**
+ * Adds delta to the mark at this time
+ */
+void StackDistance::add(size_t time, int delta) {
+    for (; time < tree.size(); time += time & (~time + 1))
+        tree[time] += delta;
+}
+
+/**
+ * Returns the number of marks at or before this time
+ */
+unsigned long StackDistance::marksUpTo(size_t time) {
+    unsigned long marks = 0;
+    for (; time > 0; time -= time & (~time + 1))
+        marks += tree[time];
+    return marks;
+}
+
+/**
+ * Renumbers the latest access of every page to times 1..pages, in the same order,
+ * and makes room for at least as many new times again
+ */
+void StackDistance::compact() {
+    vector<pair<size_t, uint64_t> > latest;
+    latest.reserve(lastAccess.size());
+    for (auto& page : lastAccess)
+        latest.push_back(make_pair(page.second, page.first));
+    sort(latest.begin(), latest.end());
+
+    size_t times = max((size_t) INITIAL_TIMES, 2 * latest.size());
+    tree.assign(times + 1, 0);
+    for (size_t i = 0; i < latest.size(); i++) {
+        lastAccess[latest[i].second] = i + 1;
+        tree[i + 1] = 1;
+    }
+
+    //Build the tree over the marks in place, each node passes its sum to its parent
+    for (size_t time = 1; time < tree.size(); time++) {
+        size_t parent = time + (time & (~time + 1));
+        if (parent < tree.size())
+            tree[parent] += tree[time];
+    }
+
+    now = latest.size();
+}
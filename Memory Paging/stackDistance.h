@@ -0,0 +1,46 @@
+//This is the work of Teddy Barker
+
+#ifndef STACKDISTANCE_H
+#define STACKDISTANCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Stack Distance class
+ *   Computes the LRU stack distance of every page accessed, the number
+ *   of distinct pages touched since its last access, in a single pass.
+ *   A fully associative LRU TLB of capacity C hits exactly the accesses
+ *   with a distance of at most C, so one pass gives the hit rate of
+ *   every capacity at once.
+ *
+ *   Each page keeps a mark at the time of its latest access in a Fenwick
+ *   tree, so the distance is a count of marks after that time. Once the
+ *   tree runs out of times, the live marks are packed to the front.
+*/
+class StackDistance {
+    public:
+        StackDistance(unsigned int maxDistance);
+
+        void access(uint64_t vpn);
+
+        unsigned long getAccessCount();
+        void getHitCurve(unsigned long* hits);
+
+    private:
+        unsigned int maxDistance;
+        std::vector<unsigned long> distanceCounts; //distanceCounts[d] accesses at distance d, 0 unused
+        unsigned long accessCount;
+
+        std::unordered_map<uint64_t, size_t> lastAccess; //Page to the time of its latest access
+        std::vector<int> tree; //Fenwick tree over times, 1 based
+        size_t now;
+
+        void add(size_t time, int delta);
+        unsigned long marksUpTo(size_t time);
+        void compact();
+};
+
+#endif
@@ -0,0 +1,226 @@
+//This is the work of Teddy Barker
+
+#include "sweep.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cstdlib>
+
+using namespace std;
+
+/************
+** METHODS **
+************/
+/**
+ * Reads one configuration per line from the sweep file at path. Blank lines
+ * and lines starting with # are skipped. Returns false with a message in
+ * error if the file can not be read or a line is not a valid configuration
+ */
+bool Sweep::load(const char* path, string& error) {
+    ifstream file(path);
+    if (!file) {
+        error = string("Unable to open <<") + path + ">>";
+        return false;
+    }
+
+    configs.clear();
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#')
+            continue;
+
+        SweepConfig sweepConfig;
+        if (!parseConfig(line.substr(start), sweepConfig, error)) {
+            error = "Sweep line " + to_string(lineNumber) + ": " + error;
+            return false;
+        }
+        configs.push_back(sweepConfig);
+    }
+
+    if (configs.empty()) {
+        error = "No configurations in the sweep file";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parses a configuration in the same form as the command line, the TLB
+ * options -c, -a, -I, -D and -r, the backend -b, the walk cache -w and
+ * huge pages -H followed by the page table level sizes
+ */
+bool Sweep::parseConfig(const string& line, SweepConfig& sweepConfig, string& error) {
+    sweepConfig.label = line;
+    sweepConfig.levelCount = 0;
+    sweepConfig.config = SimulatorConfig();
+    sweepConfig.config.addressBits = BIT_SIZE;
+    sweepConfig.config.evictionPolicy = EVICT_CLOCK;
+    sweepConfig.config.workingSetWindow = DEFAULT_WORKING_SET_WINDOW;
+
+    istringstream tokens(line);
+    string token;
+    int totalBits = 0;
+    while (tokens >> token) {
+        if (token.size() == 2 && token[0] == '-') {
+            //A TLB option and its value
+            string value;
+            if (!(tokens >> value)) {
+                error = "Option " + token + " needs a value";
+                return false;
+            }
+
+            int number = atoi(value.c_str());
+            switch (token[1]) {
+                case 'c':
+                    sweepConfig.config.tlbSize = number;
+                    break;
+                case 'a':
+                    sweepConfig.config.tlbWays = number;
+                    break;
+                case 'I':
+                    sweepConfig.config.itlbSize = number;
+                    break;
+                case 'D':
+                    sweepConfig.config.dtlbSize = number;
+                    break;
+                case 'F':
+                    sweepConfig.config.frameLimit = number;
+                    break;
+                case 'e':
+                    if (!FrameTable::parse(value.c_str(), sweepConfig.config.evictionPolicy, sweepConfig.config.workingSetWindow)) {
+                        error = "Eviction policy must be one of fifo, clock or wsclock[:window]";
+                        return false;
+                    }
+                    continue;
+                case 'r':
+                    if (!ReplacementPolicy::parse(value.c_str(), sweepConfig.config.tlbPolicy)) {
+                        error = "Replacement policy must be one of lru, clock, plru, random or arc";
+                        return false;
+                    }
+                    continue;
+                case 'b':
+                    if (!PageTable::parse(value.c_str(), sweepConfig.config.pageTableBackend)) {
+                        error = "Page table backend must be one of levels, hashed or adaptive";
+                        return false;
+                    }
+                    continue;
+                case 'H':
+                    if (!parseHugePages(value.c_str(), sweepConfig.config)) {
+                        error = "Huge pages must be a level greater than 0, optionally followed by :<pages> greater than 0";
+                        return false;
+                    }
+                    continue;
+                case 'w':
+                    if (!PageWalkCache::parse(value.c_str(), sweepConfig.config.walkCacheSizes)) {
+                        error = "Walk cache sizes must be numbers, greater than or equal to 0, separated by commas";
+                        return false;
+                    }
+                    continue;
+                default:
+                    error = "Invalid argument " + token;
+                    return false;
+            }
+            if (number < 0) {
+                error = "Option " + token + " must be a number, greater than or equal to 0";
+                return false;
+            }
+            continue;
+        }
+
+        //A page table level size in bits
+        int bits = atoi(token.c_str());
+        if (bits <= 0) {
+            error = "Level " + to_string(sweepConfig.levelCount) + " page table must be at least 1 bit";
+            return false;
+        }
+        totalBits += bits;
+        if (totalBits > 28) {
+            error = "Too many bits used in page tables";
+            return false;
+        }
+        sweepConfig.entryCount[sweepConfig.levelCount++] = 1 << bits;
+    }
+
+    if (sweepConfig.levelCount == 0) {
+        error = "No page table level sizes";
+        return false;
+    }
+
+    //The same checks as the command line
+    return isValidConfig(sweepConfig.config, sweepConfig.levelCount, sweepConfig.entryCount, false, error);
+}
+
+/**
+ * Simulates every configuration over the first recordCount records of the
+ * trace, on up to threads worker threads
+ */
+void Sweep::run(TraceMap* traceMap, size_t recordCount, unsigned int threads) {
+    results.assign(configs.size(), SweepResult());
+
+    if (threads > configs.size())
+        threads = configs.size();
+    if (threads < 1)
+        threads = 1;
+
+    //Each worker claims the next configuration until none are left
+    atomic<size_t> nextConfig(0);
+    vector<thread> workers;
+    for (unsigned int i = 0; i < threads; i++) {
+        workers.push_back(thread([this, traceMap, recordCount, &nextConfig]() {
+            size_t index;
+            while ((index = nextConfig.fetch_add(1)) < configs.size())
+                simulate(traceMap, recordCount, index);
+        }));
+    }
+
+    for (thread& worker : workers)
+        worker.join();
+}
+
+/**
+ * Runs one configuration over the trace on the calling thread and stores its summary
+ */
+void Sweep::simulate(TraceMap* traceMap, size_t recordCount, size_t index) {
+    SweepConfig& sweepConfig = configs[index];
+    Simulator simulator(sweepConfig.levelCount, sweepConfig.entryCount, sweepConfig.config);
+
+    //Time the translations only, so backends can be compared on walk time
+    const p2AddrTr* records = traceMap->getRecords();
+    Translation translation;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t record = 0; record < recordCount; record++)
+        simulator.translate(records[record].addr, records[record].reqtype, records[record].time, translation);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    PageTable* pageTable = simulator.getPageTable();
+    SweepResult& result = results[index];
+    result.pageSize = 1 << pageTable->getShiftAry()[sweepConfig.levelCount - 1];
+    result.accesses = simulator.getAccessCount();
+    result.tlbHits = simulator.getTlbHits();
+    result.pageTableHits = simulator.getPageTableHits();
+    result.framesAllocated = pageTable->getFramesAllocated();
+    result.pageTableEntries = pageTable->getTotalPageTableEntries();
+    result.pageTableBytes = pageTable->getBytesUsed();
+    result.seconds = elapsed.count();
+}
+
+/**
+ * Getter for the configurations, in the order of the sweep file
+ */
+vector<SweepConfig>& Sweep::getConfigs() {
+    return configs;
+}
+
+/**
+ * Getter for the results, one per configuration in the same order
+ */
+vector<SweepResult>& Sweep::getResults() {
+    return results;
+}
@@ -0,0 +1,63 @@
+//This is the work of Teddy Barker
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "simulator.h"
+#include "traceMap.h"
+
+/**
+ * This Struct holds one configuration of a sweep:
+ *  - the line of the sweep file it came from
+ *  - page table level count and entry count of every level
+ *  - TLB configuration
+ */
+struct SweepConfig {
+    std::string label;
+    unsigned int levelCount;
+    unsigned int entryCount[MAX_LEVELS];
+    SimulatorConfig config;
+};
+
+/**
+ * This Struct holds the summary of one configuration once it has run,
+ * with the memory its page table reserved and the time its translations took
+ */
+struct SweepResult {
+    unsigned int pageSize;
+    unsigned long accesses;
+    unsigned long tlbHits;
+    unsigned long pageTableHits;
+    unsigned int framesAllocated;
+    unsigned long pageTableEntries;
+    size_t pageTableBytes;
+    double seconds;
+};
+
+/*
+ * Sweep class
+ *   Simulates many configurations over one mapped trace. Each worker
+ *   thread takes the next configuration that has not run, builds its own
+ *   simulator for it and walks the shared, read-only records.
+*/
+class Sweep {
+    public:
+        bool load(const char* path, std::string& error);
+        void run(TraceMap* traceMap, size_t recordCount, unsigned int threads);
+
+        std::vector<SweepConfig>& getConfigs();
+        std::vector<SweepResult>& getResults();
+
+        static bool parseConfig(const std::string& line, SweepConfig& sweepConfig, std::string& error);
+
+    private:
+        std::vector<SweepConfig> configs;
+        std::vector<SweepResult> results;
+
+        void simulate(TraceMap* traceMap, size_t recordCount, size_t index);
+};
+
+#endif
@@ -1,69 +1,231 @@
 //This is the work of Teddy Barker
 
 #include "tlb.h"
-#include <iostream> 
 
-//Constructor to initialize TLB of a given size
-TLB::TLB(int size) {
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Way search for set associative TLBs. Each returns the first way in a
+ * set of paddedWays ways that holds tag, or TLB_NONE. The SIMD versions
+ * compare 2 or 4 tags per instruction and turn the result into a bit
+ * per way with movemask, so a hit is the lowest set bit.
+ */
+static int findWayScalar(const uint64_t* tags, int paddedWays, uint64_t tag) {
+    for (int way = 0; way < paddedWays; way++) {
+        if (tags[way] == tag)
+            return way;
+    }
+    return TLB_NONE;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static int findWaySSE2(const uint64_t* tags, int paddedWays, uint64_t tag) {
+    __m128i key = _mm_set1_epi64x(tag);
+    for (int way = 0; way < paddedWays; way += 2) {
+        __m128i lanes = _mm_loadu_si128((const __m128i*) (tags + way));
+
+        //SSE2 only compares 32 bit lanes, a tag matches when both of its halves do
+        __m128i halves = _mm_cmpeq_epi32(lanes, key);
+        __m128i matches = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        int hits = _mm_movemask_pd(_mm_castsi128_pd(matches));
+        if (hits != 0)
+            return way + __builtin_ctz(hits);
+    }
+    return TLB_NONE;
+}
+
+__attribute__((target("avx2")))
+static int findWayAVX2(const uint64_t* tags, int paddedWays, uint64_t tag) {
+    __m256i key = _mm256_set1_epi64x(tag);
+    for (int way = 0; way < paddedWays; way += 4) {
+        __m256i lanes = _mm256_loadu_si256((const __m256i*) (tags + way));
+        int hits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lanes, key)));
+        if (hits != 0)
+            return way + __builtin_ctz(hits);
+    }
+    return TLB_NONE;
+}
+#endif
+
+//Constructor to initialize TLB of a given size, fully associative if ways is 0
+TLB::TLB(int size, int ways, ReplacementPolicyType policyType) {
     tlbSize = size;
-    entries = new TLBEntry[size];
-    global_lruCounter = 0;  //Initialize global LRU counter
-
-    //Initialize TLB entries with invalid values
-    for (int i = 0; i < size; i++) {
-        entries[i].vpn = -1; //Invalid VPN
-        entries[i].pfn = -1; //Invalid PFN
-        entries[i].lruCounter = -1; //Not used yet
+    fullyAssociative = (ways == 0);
+    this->ways = fullyAssociative ? size : ways;
+
+    buckets = nullptr;
+    freeWays = nullptr;
+    used = 0; //No entries in use yet
+    freeCount = 0;
+
+    if (fullyAssociative) {
+        //A single set, searched through the index instead of tag by tag
+        setMask = 0;
+        paddedWays = size;
+        findWay = nullptr;
+
+        //Size the index to a power of 2 at least twice the TLB, so probes stay short
+        unsigned int bucketBits = 1;
+        while ((1u << bucketBits) < 2u * size)
+            bucketBits++;
+        bucketMask = (1u << bucketBits) - 1;
+        bucketShift = 64 - bucketBits;
+
+        buckets = new int[bucketMask + 1];
+        for (unsigned int i = 0; i <= bucketMask; i++)
+            buckets[i] = TLB_NONE;
+        freeWays = new int[size];
+    } else {
+        //Set associative, size / ways sets that are a power of 2 so the set is the low VPN bits
+        setMask = size / ways - 1;
+
+        //Pad every set to whole SIMD registers, 2 tags for SSE2 and 4 for AVX2
+        paddedWays = (ways + 1) & ~1;
+        findWay = findWayScalar;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (ways > 2 && __builtin_cpu_supports("avx2")) {
+            paddedWays = (ways + 3) & ~3;
+            findWay = findWayAVX2;
+        } else if (__builtin_cpu_supports("sse2")) {
+            findWay = findWaySSE2;
+        }
+#endif
+    }
+
+    int slots = (setMask + 1) * paddedWays;
+    tags = new uint64_t[slots];
+    pfns = new unsigned int[slots];
+
+    //Initialize every way, padding included, as empty
+    for (int i = 0; i < slots; i++) {
+        tags[i] = TLB_INVALID_TAG; //Invalid VPN
+        pfns[i] = -1; //Invalid PFN
     }
+
+    policy = ReplacementPolicy::create(policyType, setMask + 1, this->ways);
 }
 
 //Destructor to clean up memory
 TLB::~TLB() {
-    delete[] entries;
+    delete[] tags;
+    delete[] pfns;
+    delete[] buckets;
+    delete[] freeWays;
+    delete policy;
 }
 
-//Lookup VPN in the TLB, return PFN or -1 if not found
-int TLB::lookup(unsigned int vpn) {
-    //Increment the gloval lru counter
-    global_lruCounter++;
-    for (int i = 0; i < tlbSize; i++) {
-        if (entries[i].vpn == vpn) {
-            //update lru counter since this entry was accessed
-            entries[i].lruCounter = global_lruCounter;
-            return entries[i].pfn; //Return the corresponding PFN
-        }
-    }
-    return -1;  //TLB miss
+//Lookup VPN of address space asid in the TLB, return PFN or -1 if not found
+int TLB::lookup(uint64_t vpn, unsigned int asid) {
+    uint64_t tag = ((uint64_t) asid << TLB_ASID_SHIFT) | vpn;
+    int set = vpn & setMask;
+    int way;
+
+    if (fullyAssociative)
+        way = buckets[findBucket(tag)];
+    else
+        way = findWay(tags + set * paddedWays, paddedWays, tag);
+
+    if (way == TLB_NONE)
+        return -1; //TLB miss
+
+    //Tell the policy this way was accessed
+    policy->touch(set, way);
+    return pfns[set * paddedWays + way]; //Return the corresponding PFN
 }
 
-//Insert new VPN -> PFN mapping into the TLB
-void TLB::insert(unsigned int vpn, unsigned int pfn) {
-    //Check if there's an empty slot in the TLB
-    for (int i = 0; i < tlbSize; i++) {
-        if (entries[i].vpn == -1) {
-            //Insert in the empty slot
-            entries[i].vpn = vpn;
-            entries[i].pfn = pfn;
-            entries[i].lruCounter = global_lruCounter;
-            return;
-        }
+//Insert new VPN -> PFN mapping of address space asid into the TLB
+void TLB::insert(uint64_t vpn, unsigned int pfn, unsigned int asid) {
+    uint64_t tag = ((uint64_t) asid << TLB_ASID_SHIFT) | vpn;
+    int set = vpn & setMask;
+    int way;
+
+    //Check if there's an empty way in the set, empty ways and padding hold the invalid tag
+    if (fullyAssociative && freeCount > 0)
+        way = freeWays[--freeCount];
+    else if (fullyAssociative)
+        way = (used < tlbSize) ? used++ : TLB_NONE;
+    else
+        way = findWay(tags + set * paddedWays, paddedWays, TLB_INVALID_TAG);
+
+    //If no empty way, let the policy pick the one to replace
+    if (way == TLB_NONE || way >= ways)
+        way = policy->victim(set, tag);
+
+    replaceEntry(set, way, tag, pfn);
+}
+
+//Remove the VPN -> PFN mapping of address space asid from the TLB, if it holds one
+void TLB::invalidate(uint64_t vpn, unsigned int asid) {
+    uint64_t tag = ((uint64_t) asid << TLB_ASID_SHIFT) | vpn;
+    int set = vpn & setMask;
+    int way;
+
+    if (fullyAssociative)
+        way = buckets[findBucket(tag)];
+    else
+        way = findWay(tags + set * paddedWays, paddedWays, tag);
+
+    if (way == TLB_NONE)
+        return;
+
+    //The emptied way is filled again before the policy is asked for a victim
+    if (fullyAssociative) {
+        unindexEntry(tag);
+        freeWays[freeCount++] = way;
     }
+    int slot = set * paddedWays + way;
+    tags[slot] = TLB_INVALID_TAG;
+    pfns[slot] = -1;
+    policy->invalidate(set, way);
+}
 
-    //If no empty slot, find the least recently used entry and replace it
-    int lruIndex = 0;
-    for (int i = 1; i < tlbSize; i++) {
-        if (entries[i].lruCounter < entries[lruIndex].lruCounter) {
-            lruIndex = i;
-        }
+//Replace an entry in the TLB with a new mapping
+void TLB::replaceEntry(int set, int way, uint64_t tag, unsigned int pfn) {
+    int slot = set * paddedWays + way;
+
+    if (fullyAssociative) {
+        if (tags[slot] != TLB_INVALID_TAG)
+            unindexEntry(tags[slot]);
+        buckets[findBucket(tag)] = way;
     }
 
-    //Replace the LRU entry
-    replaceEntry(lruIndex, vpn, pfn);
+    tags[slot] = tag;
+    pfns[slot] = pfn;
+    policy->fill(set, way, tag);
+}
+
+//Hash a tag to its home bucket, multiplying by 2^64 / golden ratio spreads nearby pages apart
+unsigned int TLB::bucketOf(uint64_t tag) {
+    return (tag * 0x9E3779B97F4A7C15ull) >> bucketShift;
+}
+
+//Find the bucket holding this tag, or the empty bucket that ends its probe sequence
+int TLB::findBucket(uint64_t tag) {
+    unsigned int bucket = bucketOf(tag);
+    while (buckets[bucket] != TLB_NONE && tags[buckets[bucket]] != tag)
+        bucket = (bucket + 1) & bucketMask;
+    return bucket;
 }
 
-//Replace an entry in the TLB using the LRU policy
-void TLB::replaceEntry(int index, unsigned int vpn, unsigned int pfn) {
-    entries[index].vpn = vpn;
-    entries[index].pfn = pfn;
-    entries[index].lruCounter = global_lruCounter;
-}
\ No newline at end of file
+//Remove a tag from the index, shifting back later entries of the probe sequence so no lookup stops early
+void TLB::unindexEntry(uint64_t tag) {
+    unsigned int hole = findBucket(tag);
+    buckets[hole] = TLB_NONE;
+
+    unsigned int bucket = (hole + 1) & bucketMask;
+    while (buckets[bucket] != TLB_NONE) {
+        unsigned int home = bucketOf(tags[buckets[bucket]]);
+
+        //Move the entry into the hole unless its home lies cyclically in (hole, bucket]
+        if (((bucket - home) & bucketMask) >= ((bucket - hole) & bucketMask)) {
+            buckets[hole] = buckets[bucket];
+            buckets[bucket] = TLB_NONE;
+            hole = bucket;
+        }
+        bucket = (bucket + 1) & bucketMask;
+    }
+}
@@ -3,36 +3,75 @@
 #ifndef TLB_H
 #define TLB_H
 
-/**
- * This Struct mimics a TLB entry and manages three attributes:
- *  - virtual page number
- *  - physical frame number
- *  - least recently used counter
- */
-struct TLBEntry {
-    unsigned int vpn;
-    unsigned int pfn;
-    int lruCounter;
-};
+#include <stdint.h>
+#include "replacementPolicy.h"
+
+//Marks an empty bucket of the VPN index and a way that was not found
+#define TLB_NONE -1
+
+//The ASID sits in the top byte of a tag, above VPNs of up to 55 bits
+#define TLB_ASID_SHIFT 56
+
+//Widest VPN a tag holds, the bit above it marks the entry of a huge page
+#define TLB_VPN_BITS 55
+#define TLB_HUGE_PAGE_TAG (1ull << TLB_VPN_BITS)
+
+//Tag of an empty way, no VPN is this large
+#define TLB_INVALID_TAG 0xFFFFFFFFFFFFFFFFull
 
 /**
- * This class is a Translation Lookaside Buffer and manages three attributes:
- *  - tlb size
- *  - global least recently used counter
- *  - list of TLB Entries
+ * This class is a Translation Lookaside Buffer. Its entries are kept as a
+ * structure of arrays, tags and PFNs, split into sets of ways, and a
+ * replacement policy picks which way of a full set to replace.
+ *
+ * Fully associative (ways of 0) is a single set of every entry, found in
+ * O(1) through an open addressing index from VPN to way.
+ *
+ * N-way set associative picks the set from the low VPN bits and compares
+ * the tags of the whole set at once with SIMD where the CPU has it. Each
+ * set is padded to a whole number of SIMD lanes with invalid tags.
+ *
+ * Every tag also holds the address space (ASID) of its entry above the
+ * VPN, so an entry only matches lookups from that address space and the
+ * entries of several processes can share the TLB without flushing it on
+ * a switch. ASIDs are 8 bits, enough for every p2AddrTr.proc.
+ *
+ * The TLB does not know about page sizes, a huge page is cached under its
+ * huge page number with TLB_HUGE_PAGE_TAG set so it can not match a VPN.
  */
 class TLB {
 public:
-    TLB(int size);
+    TLB(int size, int ways, ReplacementPolicyType policyType);
     ~TLB();
-    int lookup(unsigned int vpn);
-    void insert(unsigned int vpn, unsigned int pfn);
+    int lookup(uint64_t vpn, unsigned int asid);
+    void insert(uint64_t vpn, unsigned int pfn, unsigned int asid);
+    void invalidate(uint64_t vpn, unsigned int asid);
 
 private:
-    TLBEntry* entries;
     int tlbSize;
-    int global_lruCounter;
-    void replaceEntry(int index, unsigned int vpn, unsigned int pfn);
+    int ways; //Ways per set, every entry when fully associative
+    bool fullyAssociative;
+    unsigned int setMask;
+    int paddedWays;
+
+    uint64_t* tags;
+    unsigned int* pfns;
+    int used; //Ways filled so far, when fully associative
+    int* freeWays; //Ways emptied by invalidate, when fully associative
+    int freeCount;
+    ReplacementPolicy* policy;
+    int (*findWay)(const uint64_t* tags, int paddedWays, uint64_t tag);
+
+    //Fully associative index
+    int* buckets;
+    unsigned int bucketMask;
+    unsigned int bucketShift;
+
+    void replaceEntry(int set, int way, uint64_t tag, unsigned int pfn);
+
+    unsigned int bucketOf(uint64_t tag);
+    int findBucket(uint64_t tag);
+    void unindexEntry(uint64_t tag);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,330 @@
+//This is the work of Teddy Barker
+
+#include "tlbHierarchy.h"
+#include "tracereader.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+TLBHierarchy::TLBHierarchy(const SimulatorConfig& config) {
+    //Create each TLB whose cache size is specified, fully associative unless ways are given
+    tlb = nullptr;
+    itlb = nullptr;
+    dtlb = nullptr;
+    if (config.tlbSize > 0)
+        tlb = new TLB(config.tlbSize, config.tlbWays, config.tlbPolicy);
+    if (config.itlbSize > 0)
+        itlb = new TLB(config.itlbSize, config.tlbWays, config.tlbPolicy);
+    if (config.dtlbSize > 0)
+        dtlb = new TLB(config.dtlbSize, config.tlbWays, config.tlbPolicy);
+
+    itlbStats = TLBLevelStats();
+    dtlbStats = TLBLevelStats();
+    tlbStats = TLBLevelStats();
+    hugePageBits = 0;
+}
+
+TLBHierarchy::~TLBHierarchy() {
+    delete tlb;
+    delete itlb;
+    delete dtlb;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Returns true if every TLB of the configuration can be built, a set
+ * associative TLB needs its capacity to be its ways times a power of 2
+ */
+bool hasValidTlbGeometry(const SimulatorConfig& config) {
+    int tlbSizes[] = { config.tlbSize, config.itlbSize, config.dtlbSize };
+    for (int size : tlbSizes) {
+        if (size > 0 && config.tlbWays > 0) {
+            int sets = size / config.tlbWays;
+            if (size % config.tlbWays != 0 || (sets & (sets - 1)) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks the parts of a configuration that depend on each other. Per process address
+ * spaces can not have a walk cache, huge pages or a frame limit
+ */
+bool isValidConfig(const SimulatorConfig& config, unsigned int levelCount, const unsigned int* entryCount,
+                   bool perProcess, string& error) {
+    //The walk cache holds the upper levels of a radix tree, every level above the leaves at most
+    if (!config.walkCacheSizes.empty()) {
+        if (config.pageTableBackend == BACKEND_HASHED || perProcess) {
+            error = "A walk cache needs a levels or adaptive page table, and can not be used with -P";
+            return false;
+        }
+        if (config.walkCacheSizes.size() >= levelCount) {
+            error = "Walk cache sizes can only be given for the " + to_string(levelCount - 1) + " levels above the leaves";
+            return false;
+        }
+    }
+
+    //A huge page is a level of the radix tree below the root, and walks can not start inside one
+    if (config.hugePageDepth > 0) {
+        if (config.pageTableBackend == BACKEND_HASHED || perProcess) {
+            error = "Huge pages need a levels or adaptive page table, and can not be used with -P";
+            return false;
+        }
+        if (config.hugePageDepth >= levelCount) {
+            error = "Huge pages must be at a level from 1 to " + to_string(levelCount - 1);
+            return false;
+        }
+        int hugePageBits = 0;
+        for (unsigned int i = config.hugePageDepth; i < levelCount; i++)
+            hugePageBits += __builtin_ctz(entryCount[i]);
+        if (hugePageBits > MAX_FIELD_BITS) {
+            error = "Huge pages can span at most " + to_string(MAX_FIELD_BITS) + " bits of page indices";
+            return false;
+        }
+        if (config.walkCacheSizes.size() > config.hugePageDepth) {
+            error = "Walk cache sizes can only be given for the levels above the huge pages";
+            return false;
+        }
+    }
+
+    //A huge page takes a whole aligned run of frames, and address spaces would each need their own share of memory
+    if (config.frameLimit > 0 && (config.hugePageDepth > 0 || perProcess)) {
+        error = "A frame limit can not be used with huge pages or -P";
+        return false;
+    }
+
+    //A set associative TLB needs a power of 2 number of sets, at every level of the hierarchy
+    if (!hasValidTlbGeometry(config)) {
+        error = "Cache capacity must be the number of ways times a power of 2";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parses the huge page option, the depth of the levels that become huge
+ * pages optionally followed by the pages they need mapped, such as 3 or
+ * 3:256. Returns false if it is not in that form
+ */
+bool parseHugePages(const char* value, SimulatorConfig& config) {
+    char* end;
+    long depth = strtol(value, &end, 10);
+    if (end == value || depth <= 0)
+        return false;
+
+    long threshold = 0;
+    if (*end == ':') {
+        const char* pages = end + 1;
+        threshold = strtol(pages, &end, 10);
+        if (end == pages || threshold <= 0)
+            return false;
+    }
+    if (*end != '\0')
+        return false;
+
+    config.hugePageDepth = depth;
+    config.hugePageThreshold = threshold;
+    return true;
+}
+
+/**
+ * Lets every TLB hold huge pages of hugePageBits VPN bits, their entries
+ * tagged with the huge page number
+ */
+void TLBHierarchy::enableHugePages(unsigned int hugePageBits) {
+    this->hugePageBits = hugePageBits;
+}
+
+/**
+ * Looks up a VPN of address space asid from L1 down, returning its PFN or -1 on a miss.
+ * Instruction fetches go to the L1 instruction TLB and everything else to the L1 data TLB.
+ * level is set to the TLB level that answered, 0 on a miss, and hugePage to whether
+ * the entry was a huge page
+ */
+int TLBHierarchy::lookup(uint64_t vpn, unsigned char reqtype, unsigned int asid, unsigned char& level, bool& hugePage) {
+    int pfn = -1;
+    level = 0;
+    hugePage = false;
+
+    //Check the L1 TLB for this kind of access first
+    TLB* l1 = l1For(reqtype);
+    TLBLevelStats* l1Stats = (reqtype == FETCH) ? &itlbStats : &dtlbStats;
+
+    if (l1 != nullptr) {
+        l1Stats->lookups++;
+        pfn = probe(l1, vpn, asid, hugePage);
+        if (pfn != -1) {
+            level = 1;
+            l1Stats->hits++;
+        }
+    }
+
+    //Then the unified TLB
+    if (pfn == -1 && tlb != nullptr) {
+        tlbStats.lookups++;
+        pfn = probe(tlb, vpn, asid, hugePage);
+        if (pfn != -1) {
+            level = 2;
+            tlbStats.hits++;
+            if (l1 != nullptr) {
+                fill(l1, vpn, pfn, asid, hugePage); //Fill the L1 TLB
+            }
+        }
+    }
+
+    return pfn;
+}
+
+/**
+ * Inserts a translation found by a page walk into every TLB it passed on the way down.
+ * A huge page is cached as a single entry for every page in it
+ */
+void TLBHierarchy::insert(uint64_t vpn, unsigned int pfn, unsigned char reqtype, unsigned int asid, bool hugePage) {
+    TLB* l1 = l1For(reqtype);
+    if (tlb != nullptr) {
+        fill(tlb, vpn, pfn, asid, hugePage);
+    }
+    if (l1 != nullptr) {
+        fill(l1, vpn, pfn, asid, hugePage);
+    }
+}
+
+/**
+ * Looks up and fills the TLBs the way lookup and insert would for this access, without
+ * counting anything. This is the functional warming of the TLBs, which keeps their entries
+ * and replacement state as a detailed run would have them. pfn and hugePage are the page
+ * table's translation, used on a miss. Returns the PFN, with level and hugePage set as
+ * lookup sets them
+ */
+int TLBHierarchy::warm(uint64_t vpn, unsigned int pfn, unsigned char reqtype, unsigned int asid, unsigned char& level,
+                       bool& hugePage) {
+    bool cachedHugePage = false;
+    TLB* l1 = l1For(reqtype);
+    if (l1 != nullptr) {
+        int cachedPfn = probe(l1, vpn, asid, cachedHugePage);
+        if (cachedPfn != -1) {
+            level = 1;
+            hugePage = cachedHugePage;
+            return cachedPfn;
+        }
+    }
+
+    if (tlb != nullptr) {
+        int cachedPfn = probe(tlb, vpn, asid, cachedHugePage);
+        if (cachedPfn != -1) {
+            if (l1 != nullptr)
+                fill(l1, vpn, cachedPfn, asid, cachedHugePage);
+            level = 2;
+            hugePage = cachedHugePage;
+            return cachedPfn;
+        }
+    }
+
+    level = 0;
+    insert(vpn, pfn, reqtype, asid, hugePage);
+    return pfn;
+}
+
+/**
+ * Removes the small page entry of a VPN of address space asid from every TLB,
+ * for a mapping the page table no longer uses
+ */
+void TLBHierarchy::invalidate(uint64_t vpn, unsigned int asid) {
+    if (tlb != nullptr)
+        tlb->invalidate(vpn, asid);
+    if (itlb != nullptr)
+        itlb->invalidate(vpn, asid);
+    if (dtlb != nullptr)
+        dtlb->invalidate(vpn, asid);
+}
+
+/**
+ * Returns true if level is the first TLB a lookup of this kind of access probes,
+ * its L1 TLB if it has one and the unified TLB otherwise
+ */
+bool TLBHierarchy::isFirstLevel(unsigned char reqtype, unsigned char level) {
+    return level == ((l1For(reqtype) != nullptr) ? 1 : 2);
+}
+
+/**
+ * Counts count lookups that hit the first TLB of this kind of access, at this level,
+ * without probing it. Only valid for repeats of a lookup that just hit there, the
+ * replacement policies already have that entry as recently used as it can be
+ */
+void TLBHierarchy::countRepeatHits(unsigned char reqtype, unsigned char level, unsigned long count) {
+    TLBLevelStats* stats = (level == 2) ? &tlbStats : (reqtype == FETCH) ? &itlbStats : &dtlbStats;
+    stats->lookups += count;
+    stats->hits += count;
+}
+
+/**
+ * Returns true if there is an L1 instruction or data TLB in front of the unified TLB
+ */
+bool TLBHierarchy::hasL1Tlbs() {
+    return itlb != nullptr || dtlb != nullptr;
+}
+
+/**
+ * Getter for the L1 instruction TLB counts
+ */
+TLBLevelStats TLBHierarchy::getItlbStats() {
+    return itlbStats;
+}
+
+/**
+ * Getter for the L1 data TLB counts
+ */
+TLBLevelStats TLBHierarchy::getDtlbStats() {
+    return dtlbStats;
+}
+
+/**
+ * Getter for the unified TLB counts
+ */
+TLBLevelStats TLBHierarchy::getTlbStats() {
+    return tlbStats;
+}
+
+/**
+ * Returns the L1 TLB that serves this kind of access, or nullptr if there is none
+ */
+TLB* TLBHierarchy::l1For(unsigned char reqtype) {
+    return (reqtype == FETCH) ? itlb : dtlb;
+}
+
+/**
+ * Looks up a VPN in one TLB, first as a small page and then as part of a huge page.
+ * Returns the PFN of the VPN's own frame or -1, setting hugePage on a huge page hit
+ */
+int TLBHierarchy::probe(TLB* cache, uint64_t vpn, unsigned int asid, bool& hugePage) {
+    int pfn = cache->lookup(vpn, asid);
+    if (pfn != -1 || hugePageBits == 0)
+        return pfn;
+
+    //A huge page entry holds its first frame, the VPN's frame is as far into it as the VPN is into the page
+    pfn = cache->lookup((vpn >> hugePageBits) | TLB_HUGE_PAGE_TAG, asid);
+    if (pfn == -1)
+        return -1;
+
+    hugePage = true;
+    return pfn + (vpn & ((1ull << hugePageBits) - 1));
+}
+
+/**
+ * Inserts the translation of a VPN into one TLB, as an entry for its whole page when that is huge
+ */
+void TLBHierarchy::fill(TLB* cache, uint64_t vpn, unsigned int pfn, unsigned int asid, bool hugePage) {
+    if (hugePage) {
+        uint64_t pageOffset = vpn & ((1ull << hugePageBits) - 1);
+        cache->insert((vpn >> hugePageBits) | TLB_HUGE_PAGE_TAG, pfn - pageOffset, asid);
+    } else {
+        cache->insert(vpn, pfn, asid);
+    }
+}
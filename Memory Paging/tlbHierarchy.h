@@ -0,0 +1,116 @@
+//This is the work of Teddy Barker
+
+#ifndef TLBHIERARCHY_H
+#define TLBHIERARCHY_H
+
+#include <string>
+#include <vector>
+#include "tlb.h"
+#include "pageTable.h"
+
+/**
+ * This Struct holds the TLB configuration of a simulator:
+ *  - capacity and ways of the unified TLB, the L2 STLB when there are L1 TLBs
+ *  - capacity of the L1 instruction TLB and L1 data TLB
+ *  - replacement policy of every TLB
+ *  - backend of the page table behind them and the width of its virtual addresses
+ *  - entries of the page walk cache at each upper level of the page table, none if empty
+ *  - depth of the levels that can become huge pages, 0 for none, and the pages
+ *    a level needs mapped to be promoted, 0 for half of them
+ * A capacity of 0 leaves that TLB out, and ways of 0 make a TLB fully associative
+ */
+struct SimulatorConfig {
+    int tlbSize;
+    int tlbWays;
+    int itlbSize;
+    int dtlbSize;
+    ReplacementPolicyType tlbPolicy;
+    PageTableBackend pageTableBackend;
+    unsigned int addressBits;
+    std::vector<unsigned int> walkCacheSizes;
+    unsigned int hugePageDepth;
+    unsigned int hugePageThreshold;
+    unsigned int frameLimit; //Frames of physical memory, 0 for an endless supply
+    EvictionPolicyType evictionPolicy;
+    uint64_t workingSetWindow;
+};
+
+/**
+ * Parses the huge page option, the depth of the levels that become huge
+ * pages optionally followed by the pages they need mapped, such as 3 or
+ * 3:256. Returns false if it is not in that form
+ */
+bool parseHugePages(const char* value, SimulatorConfig& config);
+
+/**
+ * Returns true if every TLB of the configuration can be built, a set
+ * associative TLB needs its capacity to be its ways times a power of 2
+ */
+bool hasValidTlbGeometry(const SimulatorConfig& config);
+
+/**
+ * Checks that the walk cache, huge pages, frame limit and TLBs of a configuration
+ * fit its page table levels and each other, for the command line and sweep lines
+ * alike. Returns false with a message in error for the first one that does not
+ */
+bool isValidConfig(const SimulatorConfig& config, unsigned int levelCount, const unsigned int* entryCount,
+                   bool perProcess, std::string& error);
+
+/**
+ * This Struct counts the traffic seen by one TLB of the hierarchy:
+ *  - lookups that reached it
+ *  - lookups it answered
+ */
+struct TLBLevelStats {
+    unsigned long lookups;
+    unsigned long hits;
+};
+
+/*
+ * TLBHierarchy class
+ *   The TLBs of a configuration, L1 instruction and data TLBs in front
+ *   of a unified TLB, with the traffic counts of each. It caches
+ *   translations but never walks a page table itself, so a single
+ *   hierarchy can be shared by the page tables of several address
+ *   spaces.
+ *
+ *   With huge pages every TLB holds entries of both sizes, and a lookup
+ *   probes the VPN and then its huge page, the way a shared L2 TLB does.
+*/
+class TLBHierarchy {
+    public:
+        TLBHierarchy(const SimulatorConfig& config);
+        ~TLBHierarchy();
+
+        void enableHugePages(unsigned int hugePageBits);
+
+        int lookup(uint64_t vpn, unsigned char reqtype, unsigned int asid, unsigned char& level, bool& hugePage);
+        void insert(uint64_t vpn, unsigned int pfn, unsigned char reqtype, unsigned int asid, bool hugePage);
+        int warm(uint64_t vpn, unsigned int pfn, unsigned char reqtype, unsigned int asid, unsigned char& level,
+                 bool& hugePage);
+        void invalidate(uint64_t vpn, unsigned int asid);
+        bool isFirstLevel(unsigned char reqtype, unsigned char level);
+        void countRepeatHits(unsigned char reqtype, unsigned char level, unsigned long count);
+
+        bool hasL1Tlbs();
+        TLBLevelStats getItlbStats();
+        TLBLevelStats getDtlbStats();
+        TLBLevelStats getTlbStats();
+
+    private:
+        TLB* tlb;
+        TLB* itlb;
+        TLB* dtlb;
+
+        TLBLevelStats itlbStats;
+        TLBLevelStats dtlbStats;
+        TLBLevelStats tlbStats;
+
+        unsigned int hugePageBits; //VPN bits inside a huge page, 0 without huge pages
+
+        TLB* l1For(unsigned char reqtype);
+        int probe(TLB* cache, uint64_t vpn, unsigned int asid, bool& hugePage);
+        void fill(TLB* cache, uint64_t vpn, unsigned int pfn, unsigned int asid, bool hugePage);
+};
+
+#endif
@@ -0,0 +1,234 @@
+//This is the work of Teddy Barker
+
+#include "traceChunks.h"
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+TraceChunks::TraceChunks(unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config,
+                         unsigned int chunks, size_t warmup) {
+    this->levelCount = levelCount;
+    this->entryCount = new unsigned int[levelCount];
+    for (unsigned int i = 0; i < levelCount; i++)
+        this->entryCount[i] = entryCount[i];
+    this->config = config;
+    this->warmup = warmup;
+    results.assign(chunks, ChunkResult());
+    firstTouches.assign(chunks, vector<size_t>());
+    mergeSeconds = 0;
+
+    //The page tables run without TLBs or a walk cache, only their misses and frames are used
+    pageTableOnly = config;
+    pageTableOnly.tlbSize = 0;
+    pageTableOnly.itlbSize = 0;
+    pageTableOnly.dtlbSize = 0;
+    pageTableOnly.walkCacheSizes.clear();
+    pageTableSimulator = new Simulator(levelCount, entryCount, pageTableOnly);
+}
+
+TraceChunks::~TraceChunks() {
+    delete pageTableSimulator;
+    delete[] entryCount;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Simulates the first recordCount records of the trace, the chunks on up to threads
+ * worker threads, then merges their page tables on the calling thread
+ */
+void TraceChunks::run(TraceMap* traceMap, size_t recordCount, unsigned int threads) {
+    if (traceMap->getFormat() == TRACE_BYU64)
+        runRecords(traceMap->getRecords64(), recordCount, threads);
+    else
+        runRecords(traceMap->getRecords(), recordCount, threads);
+}
+
+/**
+ * Cuts the records into chunks and runs them, the first recordCount % chunks chunks
+ * get one record more than the rest
+ */
+template <class RECORD>
+void TraceChunks::runRecords(const RECORD* records, size_t recordCount, unsigned int threads) {
+    size_t chunks = results.size();
+    size_t firstRecord = 0;
+    for (size_t chunk = 0; chunk < chunks; chunk++) {
+        results[chunk] = ChunkResult();
+        results[chunk].firstRecord = firstRecord;
+        results[chunk].records = recordCount / chunks + (chunk < recordCount % chunks ? 1 : 0);
+        firstRecord += results[chunk].records;
+        firstTouches[chunk].clear();
+    }
+
+    if (threads > chunks)
+        threads = chunks;
+    if (threads < 1)
+        threads = 1;
+
+    //Each worker claims the next chunk until none are left
+    atomic<size_t> nextChunk(0);
+    vector<thread> workers;
+    for (unsigned int i = 0; i < threads; i++) {
+        workers.push_back(thread([this, records, chunks, &nextChunk]() {
+            size_t chunk;
+            while ((chunk = nextChunk.fetch_add(1)) < chunks)
+                simulateChunk(records, chunk);
+        }));
+    }
+
+    for (thread& worker : workers)
+        worker.join();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    mergePageTable(records);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    mergeSeconds = elapsed.count();
+}
+
+/**
+ * Translates the records of one chunk after its warm-up on a simulator of its own,
+ * keeping the TLB counts of the chunk alone and the records that first touched a page in it
+ */
+template <class RECORD>
+void TraceChunks::simulateChunk(const RECORD* records, unsigned int chunk) {
+    ChunkResult& result = results[chunk];
+    if (result.records == 0)
+        return; //More chunks than records
+    Simulator simulator(levelCount, entryCount, config);
+    Simulator chunkPageTable(levelCount, entryCount, pageTableOnly);
+    Translation translation;
+
+    //The first chunk starts the trace, so only the others have records to warm up with
+    size_t warmupStart = (result.firstRecord > warmup) ? result.firstRecord - warmup : 0;
+    result.warmupRecords = result.firstRecord - warmupStart;
+
+    for (size_t record = warmupStart; record < result.firstRecord; record++)
+        simulator.translate(records[record].addr, records[record].reqtype, records[record].time, translation);
+
+    unsigned long startTlbHits = simulator.getTlbHits();
+    TLBLevelStats startItlb = simulator.getItlbStats();
+    TLBLevelStats startDtlb = simulator.getDtlbStats();
+    TLBLevelStats startTlb = simulator.getTlbStats();
+
+    PageTable* pageTable = chunkPageTable.getPageTable();
+    uint64_t addressMask = pageTable->getAddressMask();
+    unsigned int offsetShift = pageTable->getShiftAry()[levelCount - 1];
+    vector<size_t>& touches = firstTouches[chunk];
+
+    size_t end = result.firstRecord + result.records;
+    for (size_t record = result.firstRecord; record < end; record++) {
+        simulator.translate(records[record].addr, records[record].reqtype, records[record].time, translation);
+
+        //A fault in the page table of the chunk is the first touch of a page in it
+        unsigned long faults = chunkPageTable.getWarmFaults();
+        chunkPageTable.warm(records[record].addr, (records[record].addr & addressMask) >> offsetShift,
+                                records[record].reqtype, records[record].time);
+        if (chunkPageTable.getWarmFaults() != faults)
+            touches.push_back(record);
+    }
+
+    result.tlbHits = simulator.getTlbHits() - startTlbHits;
+    result.itlb.lookups = simulator.getItlbStats().lookups - startItlb.lookups;
+    result.itlb.hits = simulator.getItlbStats().hits - startItlb.hits;
+    result.dtlb.lookups = simulator.getDtlbStats().lookups - startDtlb.lookups;
+    result.dtlb.hits = simulator.getDtlbStats().hits - startDtlb.hits;
+    result.tlb.lookups = simulator.getTlbStats().lookups - startTlb.lookups;
+    result.tlb.hits = simulator.getTlbStats().hits - startTlb.hits;
+}
+
+/**
+ * Maps the pages first touched in every chunk in the order of the chunks by functional
+ * warming, which faults on the same pages in the same order as the whole trace would
+ */
+template <class RECORD>
+void TraceChunks::mergePageTable(const RECORD* records) {
+    PageTable* pageTable = pageTableSimulator->getPageTable();
+    uint64_t addressMask = pageTable->getAddressMask();
+    unsigned int offsetShift = pageTable->getShiftAry()[levelCount - 1];
+
+    for (vector<size_t>& touches : firstTouches) {
+        for (size_t record : touches) {
+            pageTableSimulator->warm(records[record].addr, (records[record].addr & addressMask) >> offsetShift,
+                                     records[record].reqtype, records[record].time);
+        }
+        vector<size_t>().swap(touches); //Free each list once it is merged
+    }
+}
+
+/**
+ * Getter for the number of chunks
+ */
+unsigned int TraceChunks::getChunkCount() {
+    return results.size();
+}
+
+/**
+ * Getter for the counts of one chunk
+ */
+ChunkResult TraceChunks::getResult(unsigned int chunk) {
+    return results[chunk];
+}
+
+/**
+ * Sums the counts of every chunk, the records of the chunks are the whole trace
+ */
+ChunkResult TraceChunks::getTotal() {
+    ChunkResult total = ChunkResult();
+    for (ChunkResult& result : results) {
+        total.records += result.records;
+        total.warmupRecords += result.warmupRecords;
+        total.tlbHits += result.tlbHits;
+        total.itlb.lookups += result.itlb.lookups;
+        total.itlb.hits += result.itlb.hits;
+        total.dtlb.lookups += result.dtlb.lookups;
+        total.dtlb.hits += result.dtlb.hits;
+        total.tlb.lookups += result.tlb.lookups;
+        total.tlb.hits += result.tlb.hits;
+    }
+    return total;
+}
+
+/**
+ * Getter for the simulator of the page table, its warm faults are the misses of the trace
+ */
+Simulator* TraceChunks::getPageTableSimulator() {
+    return pageTableSimulator;
+}
+
+/**
+ * Getter for the seconds the page tables of the chunks took to merge, the serial part of a run
+ */
+double TraceChunks::getMergeSeconds() {
+    return mergeSeconds;
+}
+
+/**
+ * Reads <chunks>[:<warmup>] from the command line, at least one chunk and any number of
+ * warm-up records. Returns false if the text is not valid
+ */
+bool TraceChunks::parse(const char* text, unsigned int& chunks, size_t& warmup) {
+    warmup = DEFAULT_CHUNK_WARMUP;
+
+    char* end;
+    long long value = strtoll(text, &end, 10);
+    if (end == text || value <= 0 || value > MAX_CHUNKS)
+        return false;
+    chunks = value;
+
+    if (*end == ':') {
+        text = end + 1;
+        value = strtoll(text, &end, 10);
+        if (end == text || value < 0)
+            return false;
+        warmup = value;
+    }
+    return *end == '\0';
+}
@@ -0,0 +1,94 @@
+//This is the work of Teddy Barker
+
+#ifndef TRACECHUNKS_H
+#define TRACECHUNKS_H
+
+#include <stddef.h>
+#include <vector>
+#include "simulator.h"
+#include "traceMap.h"
+
+//Records before a chunk that are translated to warm its TLBs when -k does not give them
+#define DEFAULT_CHUNK_WARMUP 100000
+
+//Most chunks a trace can be cut into
+#define MAX_CHUNKS 65536
+
+/**
+ * This Struct holds the TLB counts of one chunk once the trace has run,
+ * without its warm-up:
+ *  - the first record of the chunk, its records and the records it warmed up with
+ *  - the TLB hits and the lookups and hits of every TLB of the hierarchy
+ */
+struct ChunkResult {
+    size_t firstRecord;
+    size_t records;
+    size_t warmupRecords;
+    unsigned long tlbHits;
+    TLBLevelStats itlb;
+    TLBLevelStats dtlb;
+    TLBLevelStats tlb;
+};
+
+/*
+ * Trace Chunks class
+ *   Simulates one configuration over a mapped trace on several threads.
+ *   The trace is cut into contiguous chunks of about the same number of
+ *   records, and each chunk is translated by a simulator of its own on
+ *   a worker thread, which claims the next chunk once it is done. The
+ *   warm-up records just before a chunk are translated first, and only
+ *   the counts after them are kept, so its TLBs start close to the state
+ *   a serial run would have them in.
+ *
+ *   Whether a page is mapped never depends on the TLBs, so the page
+ *   table is chunked too. Each chunk also runs its records through a
+ *   page table of its own by functional warming, and keeps the records
+ *   that first touched a page in it. A page is first touched in the
+ *   trace at one of those records, so once the workers are done the
+ *   calling thread warms the page table of the trace with only them,
+ *   chunk by chunk, which gives the exact misses, frames and page table
+ *   entries for a small part of the records. Huge pages and evictions
+ *   depend on every page mapped before, so chunks can not be used with
+ *   either. Only the TLB hits are merged from the chunks, and the page
+ *   table hits are the accesses left once both are taken out.
+*/
+class TraceChunks {
+    public:
+        TraceChunks(unsigned int levelCount, unsigned int* entryCount, const SimulatorConfig& config,
+                    unsigned int chunks, size_t warmup);
+        ~TraceChunks();
+
+        //The chunks own their page table simulator, so they can not be copied
+        TraceChunks(const TraceChunks&) = delete;
+        TraceChunks& operator=(const TraceChunks&) = delete;
+
+        void run(TraceMap* traceMap, size_t recordCount, unsigned int threads);
+
+        unsigned int getChunkCount();
+        ChunkResult getResult(unsigned int chunk);
+        ChunkResult getTotal();
+        Simulator* getPageTableSimulator();
+        double getMergeSeconds();
+
+        static bool parse(const char* text, unsigned int& chunks, size_t& warmup);
+
+    private:
+        unsigned int levelCount;
+        unsigned int* entryCount;
+        SimulatorConfig config;
+        SimulatorConfig pageTableOnly; //The config without TLBs or a walk cache
+        size_t warmup;
+        std::vector<ChunkResult> results;
+        std::vector<std::vector<size_t> > firstTouches; //Records of each chunk that first touched a page in it
+        Simulator* pageTableSimulator; //Functional warming of the page table with the first touches
+        double mergeSeconds; //Time the calling thread took to merge the page tables
+
+        template <class RECORD>
+        void runRecords(const RECORD* records, size_t recordCount, unsigned int threads);
+        template <class RECORD>
+        void simulateChunk(const RECORD* records, unsigned int chunk);
+        template <class RECORD>
+        void mergePageTable(const RECORD* records);
+};
+
+#endif
@@ -0,0 +1,145 @@
+//This is the work of Teddy Barker
+
+#include "traceMap.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+TraceMap::TraceMap() {
+    //Start with nothing mapped
+    mapping = nullptr;
+    mappingSize = 0;
+    recordCount = 0;
+    format = TRACE_BYU;
+}
+
+TraceMap::~TraceMap() {
+    close();
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Maps the trace file at path, whose records are in this format, into memory. A shared
+ * mapping is read by several threads at once. Returns false if the file can not be opened or mapped
+ */
+bool TraceMap::open(const char* path, TraceFormat format, bool shared) {
+    close();
+    this->format = format;
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    //Only whole records are walked, a trailing partial record is ignored like fread would
+    mappingSize = info.st_size;
+    recordCount = mappingSize / ((format == TRACE_BYU64) ? sizeof(p2AddrTr64) : sizeof(p2AddrTr));
+
+    if (mappingSize == 0) {
+        //Nothing to map, an empty trace simply has no records
+        ::close(fd);
+        return true;
+    }
+
+    //The records are stored little-endian, a big-endian machine swaps them once in a private copy
+    bool swap = endian() == BIG;
+    int protection = swap ? PROT_READ | PROT_WRITE : PROT_READ;
+
+    mapping = mmap(nullptr, mappingSize, protection, MAP_PRIVATE, fd, 0);
+    ::close(fd); //The mapping keeps its own reference to the file
+
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        mappingSize = 0;
+        recordCount = 0;
+        return false;
+    }
+
+    //A single simulator reads the trace front to back exactly once, so pages behind it can go. The
+    //workers of a sweep, -P or -k each read it from their own place, and chunks reread their warm-up
+    madvise(mapping, mappingSize, shared ? MADV_WILLNEED : MADV_SEQUENTIAL);
+
+    if (swap && format == TRACE_BYU64) {
+        p2AddrTr64* records = (p2AddrTr64*) mapping;
+        for (size_t i = 0; i < recordCount; i++) {
+            records[i].addr = swap_endian64(records[i].addr);
+            records[i].time = swap_endian(records[i].time);
+        }
+    } else if (swap) {
+        p2AddrTr* records = (p2AddrTr*) mapping;
+        for (size_t i = 0; i < recordCount; i++) {
+            records[i].addr = swap_endian(records[i].addr);
+            records[i].time = swap_endian(records[i].time);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Unmaps the trace, if one is mapped
+ */
+void TraceMap::close() {
+    if (mapping != nullptr)
+        munmap(mapping, mappingSize);
+
+    mapping = nullptr;
+    mappingSize = 0;
+    recordCount = 0;
+}
+
+/**
+ * Getter for the records, they stay valid until the map is closed
+ */
+const p2AddrTr* TraceMap::getRecords() {
+    return (const p2AddrTr*) mapping;
+}
+
+/**
+ * Getter for the records of a trace in the 64 bit format, they stay valid until the map is closed
+ */
+const p2AddrTr64* TraceMap::getRecords64() {
+    return (const p2AddrTr64*) mapping;
+}
+
+/**
+ * Getter for the number of whole records in the trace
+ */
+size_t TraceMap::getRecordCount() {
+    return recordCount;
+}
+
+/**
+ * Getter for the record format of the trace
+ */
+TraceFormat TraceMap::getFormat() {
+    return format;
+}
+
+/**
+ * Looks up a record format by its command line name, returns false if there is none by that name
+ */
+bool TraceMap::parse(const char* name, TraceFormat& format) {
+    if (strcmp(name, "byu") == 0) {
+        format = TRACE_BYU;
+        return true;
+    }
+    if (strcmp(name, "byu64") == 0) {
+        format = TRACE_BYU64;
+        return true;
+    }
+    return false;
+}
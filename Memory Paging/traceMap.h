@@ -0,0 +1,49 @@
+//This is the work of Teddy Barker
+
+#ifndef TRACEMAP_H
+#define TRACEMAP_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "tracereader.h"
+
+/**
+ * Record formats a trace can be in:
+ *  - BYU records with 32 bit addresses, p2AddrTr
+ *  - the same records with 64 bit addresses, p2AddrTr64
+ */
+enum TraceFormat {
+    TRACE_BYU,
+    TRACE_BYU64
+};
+
+/*
+ * Trace Map class
+ *   A memory mapping of a BYU trace file, in either record format. The records are walked in
+ *   place, so none of them are copied on the way to the simulator, and
+ *   the record count is known as soon as the file has been opened. A
+ *   shared mapping is read by several threads, each from its own place.
+*/
+class TraceMap {
+    public:
+        TraceMap();
+        ~TraceMap();
+
+        bool open(const char* path, TraceFormat format, bool shared);
+        void close();
+
+        const p2AddrTr* getRecords();
+        const p2AddrTr64* getRecords64();
+        size_t getRecordCount();
+        TraceFormat getFormat();
+
+        static bool parse(const char* name, TraceFormat& format);
+
+    private:
+        TraceFormat format;
+        void* mapping;
+        size_t mappingSize;
+        size_t recordCount;
+};
+
+#endif
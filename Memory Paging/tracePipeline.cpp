@@ -0,0 +1,124 @@
+//This is the work of Teddy Barker
+
+#include "tracePipeline.h"
+
+using namespace std;
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+TracePipeline::TracePipeline(FILE* traceFile, TraceFormat format) {
+    this->traceFile = traceFile;
+    this->format = format;
+    ring = new TraceBatch[TRACE_RING_SLOTS];
+
+    head.store(0);
+    tail.store(0);
+    finished.store(false);
+    stopping.store(false);
+}
+
+TracePipeline::~TracePipeline() {
+    stop();
+    delete[] ring;
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Starts the reader thread
+ */
+void TracePipeline::start() {
+    reader = thread(&TracePipeline::readBatches, this);
+}
+
+/**
+ * Stops the reader thread, even if the trace has not been read to the end
+ */
+void TracePipeline::stop() {
+    stopping.store(true, memory_order_release);
+    if (reader.joinable())
+        reader.join();
+}
+
+/**
+ * Waits for the next filled batch and points batch at its records.
+ * Returns the number of records in it, 0 once the trace is exhausted.
+ * The batch stays valid until releaseBatch is called
+ */
+size_t TracePipeline::nextBatch(const p2AddrTr** batch) {
+    TraceBatch* slot = waitForBatch();
+    if (slot == nullptr)
+        return 0;
+
+    *batch = slot->records;
+    return slot->count;
+}
+
+/**
+ * The same for a trace in the 64 bit format
+ */
+size_t TracePipeline::nextBatch(const p2AddrTr64** batch) {
+    TraceBatch* slot = waitForBatch();
+    if (slot == nullptr)
+        return 0;
+
+    *batch = slot->records64;
+    return slot->count;
+}
+
+/**
+ * Waits for the next filled batch, returns nullptr once the trace is exhausted
+ */
+TraceBatch* TracePipeline::waitForBatch() {
+    size_t current = tail.load(memory_order_relaxed);
+
+    while (head.load(memory_order_acquire) == current) {
+        //The ring is empty, either the reader is behind or there is nothing left
+        if (finished.load(memory_order_acquire)) {
+            //Check again, the last batch may have landed before finished was set
+            if (head.load(memory_order_acquire) == current)
+                return nullptr;
+            break;
+        }
+        this_thread::yield();
+    }
+
+    return &ring[current % TRACE_RING_SLOTS];
+}
+
+/**
+ * Hands the batch returned by nextBatch back to the reader
+ */
+void TracePipeline::releaseBatch() {
+    tail.store(tail.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+/**
+ * Body of the reader thread, fills the ring until the trace runs out
+ */
+void TracePipeline::readBatches() {
+    size_t current = head.load(memory_order_relaxed);
+
+    while (!stopping.load(memory_order_acquire)) {
+        //Wait while the ring is full
+        if (current - tail.load(memory_order_acquire) == TRACE_RING_SLOTS) {
+            this_thread::yield();
+            continue;
+        }
+
+        TraceBatch& slot = ring[current % TRACE_RING_SLOTS];
+        if (format == TRACE_BYU64)
+            slot.count = NextAddressBatch64(traceFile, slot.records64, TRACE_BATCH_SIZE);
+        else
+            slot.count = NextAddressBatch(traceFile, slot.records, TRACE_BATCH_SIZE);
+        if (slot.count == 0)
+            break;
+
+        //Publish the batch to the simulator
+        head.store(++current, memory_order_release);
+    }
+
+    finished.store(true, memory_order_release);
+}
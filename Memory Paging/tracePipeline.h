@@ -0,0 +1,65 @@
+//This is the work of Teddy Barker
+
+#ifndef TRACEPIPELINE_H
+#define TRACEPIPELINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <atomic>
+#include <thread>
+#include "tracereader.h"
+#include "traceMap.h"
+
+//Number of records read from the trace in one batch
+#define TRACE_BATCH_SIZE 4096
+
+//Number of batches the reader thread may run ahead of the simulator
+#define TRACE_RING_SLOTS 8
+
+/**
+ * This Struct is one slot of the batch ring and manages two attributes:
+ *  - the records read into this slot, in the format of the trace
+ *  - how many of them are valid
+ */
+struct TraceBatch {
+    union {
+        p2AddrTr records[TRACE_BATCH_SIZE];
+        p2AddrTr64 records64[TRACE_BATCH_SIZE];
+    };
+    size_t count;
+};
+
+/*
+ * Trace Pipeline class
+ *   Reads a trace on its own thread into a lock-free single-producer,
+ *   single-consumer ring of batches, so the simulator can translate one
+ *   batch while the next ones are still being read from the file.
+*/
+class TracePipeline {
+    public:
+        TracePipeline(FILE* traceFile, TraceFormat format);
+        ~TracePipeline();
+
+        void start();
+        void stop();
+
+        size_t nextBatch(const p2AddrTr** batch);
+        size_t nextBatch(const p2AddrTr64** batch);
+        void releaseBatch();
+
+    private:
+        FILE* traceFile;
+        TraceFormat format;
+        TraceBatch* ring;
+        std::thread reader;
+
+        std::atomic<size_t> head; //Batches filled by the reader
+        std::atomic<size_t> tail; //Batches released by the simulator
+        std::atomic<bool> finished;
+        std::atomic<bool> stopping;
+
+        void readBatches();
+        TraceBatch* waitForBatch();
+};
+
+#endif
@@ -0,0 +1,143 @@
+//This is the work of Teddy Barker
+
+#include "traceSource.h"
+
+/*****************
+** CONSTRUCTORS **
+*****************/
+TraceSource::TraceSource() {
+    //Start with nothing open
+    mapped = false;
+    mapCursor = 0;
+    traceFile = nullptr;
+    pipeline = nullptr;
+    buffer = nullptr;
+    buffer64 = nullptr;
+}
+
+TraceSource::~TraceSource() {
+    close();
+}
+
+/************
+** METHODS **
+************/
+/**
+ * Opens the trace at path, whose records are in this format, mapping it unless
+ * the reader thread was asked for. Returns false if the file can not be opened
+ */
+bool TraceSource::open(const char* path, bool useReaderThread, TraceFormat format) {
+    close();
+
+    if (!useReaderThread && traceMap.open(path, format, false)) {
+        mapped = true;
+        return true;
+    }
+
+    //Fall back to batched reads, e.g. for pipes that can not be mapped
+    traceFile = fopen(path, "r");
+    if (!traceFile)
+        return false;
+
+    if (useReaderThread) {
+        pipeline = new TracePipeline(traceFile, format);
+        pipeline->start();
+    } else if (format == TRACE_BYU64) {
+        buffer64 = new p2AddrTr64[TRACE_BATCH_SIZE];
+    } else {
+        buffer = new p2AddrTr[TRACE_BATCH_SIZE];
+    }
+    return true;
+}
+
+/**
+ * Closes the trace, stopping the reader thread if there is one
+ */
+void TraceSource::close() {
+    if (pipeline != nullptr) {
+        pipeline->stop();
+        delete pipeline;
+        pipeline = nullptr;
+    }
+    if (traceFile != nullptr) {
+        fclose(traceFile);
+        traceFile = nullptr;
+    }
+
+    delete[] buffer;
+    buffer = nullptr;
+    delete[] buffer64;
+    buffer64 = nullptr;
+
+    traceMap.close();
+    mapped = false;
+    mapCursor = 0;
+}
+
+/**
+ * Points batch at the next records of the trace and returns how many there are,
+ * 0 once the trace is exhausted. The batch stays valid until releaseBatch is called
+ */
+size_t TraceSource::nextBatch(const p2AddrTr** batch) {
+    if (mapped) {
+        //Hand out the mapped records in place
+        *batch = traceMap.getRecords() + mapCursor;
+        return nextMappedCount();
+    }
+
+    if (pipeline != nullptr)
+        return pipeline->nextBatch(batch);
+
+    *batch = buffer;
+    return NextAddressBatch(traceFile, buffer, TRACE_BATCH_SIZE);
+}
+
+/**
+ * The same for a trace in the 64 bit format
+ */
+size_t TraceSource::nextBatch(const p2AddrTr64** batch) {
+    if (mapped) {
+        *batch = traceMap.getRecords64() + mapCursor;
+        return nextMappedCount();
+    }
+
+    if (pipeline != nullptr)
+        return pipeline->nextBatch(batch);
+
+    *batch = buffer64;
+    return NextAddressBatch64(traceFile, buffer64, TRACE_BATCH_SIZE);
+}
+
+/**
+ * Moves the cursor of a mapped trace past its next batch and returns the records in that batch
+ */
+size_t TraceSource::nextMappedCount() {
+    size_t count = traceMap.getRecordCount() - mapCursor;
+    if (count > TRACE_BATCH_SIZE)
+        count = TRACE_BATCH_SIZE;
+
+    mapCursor += count;
+    return count;
+}
+
+/**
+ * Hands the batch returned by nextBatch back to the source
+ */
+void TraceSource::releaseBatch() {
+    if (pipeline != nullptr)
+        pipeline->releaseBatch();
+}
+
+/**
+ * Getter for the number of records in the trace, 0 when it is not known up front
+ */
+size_t TraceSource::getRecordCount() {
+    return mapped ? traceMap.getRecordCount() : 0;
+}
+
+/**
+ * Getter for the mapped trace, nullptr when the trace is not mapped
+ */
+TraceMap* TraceSource::getTraceMap() {
+    return mapped ? &traceMap : nullptr;
+}
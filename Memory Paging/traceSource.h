@@ -0,0 +1,47 @@
+//This is the work of Teddy Barker
+
+#ifndef TRACESOURCE_H
+#define TRACESOURCE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "tracereader.h"
+#include "traceMap.h"
+#include "tracePipeline.h"
+
+/*
+ * Trace Source class
+ *   Hands a trace to the simulator in batches, whichever way it was
+ *   opened: mapped and walked in place, read on a reader thread, or
+ *   read in batches on the calling thread when it can not be mapped.
+*/
+class TraceSource {
+    public:
+        TraceSource();
+        ~TraceSource();
+
+        bool open(const char* path, bool useReaderThread, TraceFormat format);
+        void close();
+
+        //Batches are handed out in the format the trace was opened with
+        size_t nextBatch(const p2AddrTr** batch);
+        size_t nextBatch(const p2AddrTr64** batch);
+        void releaseBatch();
+
+        size_t getRecordCount();
+        TraceMap* getTraceMap();
+
+    private:
+        TraceMap traceMap;
+        bool mapped;
+        size_t mapCursor;
+
+        FILE* traceFile;
+        TracePipeline* pipeline;
+        p2AddrTr* buffer;
+        p2AddrTr64* buffer64;
+
+        size_t nextMappedCount();
+};
+
+#endif
@@ -13,6 +13,12 @@ uint32_t swap_endian(uint32_t num)
   ((num >> 8) & 0x0000ff00) | ((num >> 24) & 0x000000ff) );
 }
 
+/* Reverse the byte order of a 64 bit trace field, one half at a time */
+uint64_t swap_endian64(uint64_t num)
+{
+  return(((uint64_t) swap_endian((uint32_t) num) << 32) | swap_endian((uint32_t) (num >> 32)));
+}
+
 /* determine if system is big- or little- endian */
 ENDIAN endian()
 {
@@ -33,6 +39,11 @@ ENDIAN endian()
     return LITTLE;
 }
 
+/* Byte order of this machine, determined once when the program loads
+ * so that the readers below do not have to test for it on every call.
+ */
+static const ENDIAN byte_order = endian();
+
 /* int NextAddress(FILE *trace_file, p2AddrTr *Addr)
  * Fetch the next address from the trace.
  *
@@ -44,15 +55,6 @@ ENDIAN endian()
 int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr) {
 
   int readN;	/* number of records stored */ 
-  static ENDIAN byte_order = UNKNOWN;	/* don't know machine format */
-
-  if (byte_order == UNKNOWN) {
-    /* First invocation.  Determine if this is a litte- or
-     * big- endian machine so that we can convert bit patterns
-     * if needed that are stored in little-endian format
-     */
-    byte_order = endian();
-  }
 
   /* Read the next address record. */
   readN = fread(addr_ptr, sizeof(p2AddrTr), 1, trace_file);
@@ -69,6 +71,56 @@ int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr) {
   return readN;    
 }
 
+/* size_t NextAddressBatch(FILE *trace_file, p2AddrTr *addr_ptr, size_t count)
+ * Fetch up to count addresses from the trace with a single read.
+ *
+ * trace_file must be a file handle to an trace file opened
+ * with fopen. User provides an array of at least count address
+ * structures.
+ *
+ * Populates the array and returns the number of records stored,
+ * 0 once the trace is exhausted.
+ */
+size_t NextAddressBatch(FILE *trace_file, p2AddrTr *addr_ptr, size_t count) {
+
+  size_t readN;	/* number of records stored */
+
+  /* Read the next block of address records. */
+  readN = fread(addr_ptr, sizeof(p2AddrTr), count, trace_file);
+
+  if (byte_order == BIG) {
+    /* records stored in little endian format, convert */
+    for (size_t i = 0; i < readN; i++) {
+      addr_ptr[i].addr = swap_endian(addr_ptr[i].addr);
+      addr_ptr[i].time = swap_endian(addr_ptr[i].time);
+    }
+  }
+
+  return readN;
+}
+
+/* size_t NextAddressBatch64(FILE *trace_file, p2AddrTr64 *addr_ptr, size_t count)
+ * Fetch up to count 64 bit addresses from the trace with a single read,
+ * as NextAddressBatch does for the 32 bit records.
+ */
+size_t NextAddressBatch64(FILE *trace_file, p2AddrTr64 *addr_ptr, size_t count) {
+
+  size_t readN;	/* number of records stored */
+
+  /* Read the next block of address records. */
+  readN = fread(addr_ptr, sizeof(p2AddrTr64), count, trace_file);
+
+  if (byte_order == BIG) {
+    /* records stored in little endian format, convert */
+    for (size_t i = 0; i < readN; i++) {
+      addr_ptr[i].addr = swap_endian64(addr_ptr[i].addr);
+      addr_ptr[i].time = swap_endian(addr_ptr[i].time);
+    }
+  }
+
+  return readN;
+}
+
 /* void AddressDecoder(p2AddrTr *addr_ptr, FILE *out)
  * Decode a Pentium II BYU address and print to the specified
  * file handle (opened by fopen in write mode)
@@ -1,3 +1,5 @@
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
 
 /* C and C++ define some of their types in different places.
  * Check and see if we are using C or C++ and include appropriately
@@ -6,9 +8,11 @@
 #ifdef __cplusplus
 /* C++ includes */
 #include <stdint.h>
+#include <stdio.h>
 #else
 /* C includes */
 #include <inttypes.h>
+#include <stdio.h>
 #endif 
 
 
@@ -22,6 +26,19 @@ typedef struct BYUADDRESSTRACE
   uint32_t time;
 } p2AddrTr;
 
+/* The same record with a 64 bit address, for traces of 48 and 57 bit
+ * virtual address spaces. Records are 16 bytes, stored little-endian.
+ */
+typedef struct BYUADDRESSTRACE64
+{
+  uint64_t addr;
+  unsigned char reqtype;
+  unsigned char size;
+  unsigned char attr;
+  unsigned char proc;
+  uint32_t time;
+} p2AddrTr64;
+
 typedef enum {
   UNKNOWN,
   LITTLE,	/* native format of trace file */
@@ -29,11 +46,28 @@ typedef enum {
 } ENDIAN;
 
 
+/* swap_endian - Reverse the byte order of a 32 bit trace field.
+ * endian - Determine the byte order of this machine.
+ */
+uint32_t swap_endian(uint32_t num);
+uint64_t swap_endian64(uint64_t num);
+ENDIAN endian();
+
 /* NextAddress - Fetch the next address from the trace.
  * See byu_tracereader.c for details.
  */
 int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr);
 
+/* NextAddressBatch - Fetch up to count addresses from the trace.
+ * Returns the number of records stored, 0 at the end of the trace.
+ */
+size_t NextAddressBatch(FILE *trace_file, p2AddrTr *addr_ptr, size_t count);
+
+/* NextAddressBatch64 - Fetch up to count 64 bit addresses from the trace.
+ * Returns the number of records stored, 0 at the end of the trace.
+ */
+size_t NextAddressBatch64(FILE *trace_file, p2AddrTr64 *addr_ptr, size_t count);
+
 /* reqtype values */
 #define FETCH			0x00	// instruction fetch
 #define MEMREAD			0x01	// memory read
@@ -55,5 +89,5 @@ int NextAddress(FILE *trace_file, p2AddrTr *addr_ptr);
 #define FLUSHACK		0x35	// acknowledge flush
 #define STOPCLKACK		0x36	// acknowledge stop clock
 #define SMIACK			0x37	// acknowledge SMI mode
-						
 
+#endif